@@ -1,36 +1,49 @@
-cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
- cirGate.h ../../include/sat.h ../../include/Solver.h \
- ../../include/SolverTypes.h ../../include/Global.h \
- ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
- ../../include/File.h cirCmd.h ../../include/cmdParser.h \
- ../../include/cmdCharDef.h ../../include/util.h ../../include/rnGen.h \
- ../../include/myUsage.h
+cirAig.o: cirAig.cpp cirAig.h cirDef.h ../../include/myHashMap.h
+cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h ../../include/myHashMap.h cirAig.h \
+ cirGate.h cirSimEngine.h cirThread.h cirFec.h cirProver.h \
+ ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
+ ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
+ ../../include/Proof.h ../../include/File.h cirStrash.h cirCmd.h \
+ ../../include/cmdParser.h ../../include/cmdCharDef.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirFec.o: cirFec.cpp cirFec.h cirDef.h ../../include/myHashMap.h \
+ cirGate.h cirAig.h cirSimEngine.h cirThread.h
 cirFraig.o: cirFraig.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
- cirGate.h ../../include/sat.h ../../include/Solver.h \
- ../../include/SolverTypes.h ../../include/Global.h \
- ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
- ../../include/File.h ../../include/util.h ../../include/rnGen.h \
- ../../include/myUsage.h
+ cirAig.h cirGate.h cirSimEngine.h cirThread.h cirFec.h cirProver.h \
+ ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
+ ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
+ ../../include/Proof.h ../../include/File.h cirStrash.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
 cirGate.o: cirGate.cpp cirGate.h cirDef.h ../../include/myHashMap.h \
+ cirAig.h cirMgr.h cirSimEngine.h cirThread.h cirFec.h cirProver.h \
  ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
  ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
- ../../include/Proof.h ../../include/File.h cirMgr.h ../../include/util.h \
- ../../include/rnGen.h ../../include/myUsage.h
-cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
- cirGate.h ../../include/sat.h ../../include/Solver.h \
- ../../include/SolverTypes.h ../../include/Global.h \
- ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
- ../../include/File.h ../../include/util.h ../../include/rnGen.h \
- ../../include/myUsage.h
-cirOpt.o: cirOpt.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
- cirGate.h ../../include/sat.h ../../include/Solver.h \
- ../../include/SolverTypes.h ../../include/Global.h \
- ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
- ../../include/File.h ../../include/util.h ../../include/rnGen.h \
- ../../include/myUsage.h
-cirSim.o: cirSim.cpp cirMgr.h cirDef.h ../../include/myHashMap.h \
- cirGate.h ../../include/sat.h ../../include/Solver.h \
+ ../../include/Proof.h ../../include/File.h cirStrash.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h ../../include/myHashMap.h cirAig.h \
+ cirGate.h cirSimEngine.h cirThread.h cirFec.h cirProver.h \
+ ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
+ ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
+ ../../include/Proof.h ../../include/File.h cirStrash.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirOpt.o: cirOpt.cpp cirMgr.h cirDef.h ../../include/myHashMap.h cirAig.h \
+ cirGate.h cirSimEngine.h cirThread.h cirFec.h cirProver.h \
+ ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
+ ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
+ ../../include/Proof.h ../../include/File.h cirStrash.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirProver.o: cirProver.cpp cirProver.h cirDef.h ../../include/myHashMap.h \
+ cirAig.h ../../include/sat.h ../../include/Solver.h \
  ../../include/SolverTypes.h ../../include/Global.h \
  ../../include/VarOrder.h ../../include/Heap.h ../../include/Proof.h \
- ../../include/File.h ../../include/util.h ../../include/rnGen.h \
- ../../include/myUsage.h
+ ../../include/File.h
+cirSim.o: cirSim.cpp cirMgr.h cirDef.h ../../include/myHashMap.h cirAig.h \
+ cirGate.h cirSimEngine.h cirThread.h cirFec.h cirProver.h \
+ ../../include/sat.h ../../include/Solver.h ../../include/SolverTypes.h \
+ ../../include/Global.h ../../include/VarOrder.h ../../include/Heap.h \
+ ../../include/Proof.h ../../include/File.h cirStrash.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirSimEngine.o: cirSimEngine.cpp cirSimEngine.h cirDef.h \
+ ../../include/myHashMap.h cirAig.h cirThread.h cirGate.h
+cirStrash.o: cirStrash.cpp cirStrash.h
+cirThread.o: cirThread.cpp cirThread.h
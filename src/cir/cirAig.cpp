@@ -0,0 +1,186 @@
+/****************************************************************************
+  FileName     [ cirAig.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the compact AIG store ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include "cirAig.h"
+
+using namespace std;
+
+const unsigned CirAig::NO_FANOUT;
+
+/*************************************/
+/*   class CirAig member functions   */
+/*************************************/
+void
+CirAig::init(unsigned vars)
+{
+   _type.assign(vars, NO_GATE);
+   _line.assign(vars, 0);
+   _fanin.assign(vars * 2, 0);
+   _symbol.clear();
+}
+
+void
+CirAig::setConst()
+{
+   _type[0] = CONST_GATE;
+}
+
+void
+CirAig::setPI(unsigned v, unsigned line)
+{
+   _type[v] = PI_GATE;
+   _line[v] = line;
+}
+
+void
+CirAig::setPO(unsigned v, unsigned line, unsigned l)
+{
+   _type[v] = PO_GATE;
+   _line[v] = line;
+   _fanin[v * 2] = l;
+}
+
+void
+CirAig::setAig(unsigned v, unsigned line, unsigned l0, unsigned l1)
+{
+   _type[v] = AIG_GATE;
+   _line[v] = line;
+   _fanin[v * 2] = l0;
+   _fanin[v * 2 + 1] = l1;
+}
+
+void
+CirAig::setUndef(unsigned v)
+{
+   _type[v] = UNDEF_GATE;
+}
+
+void
+CirAig::setMerged(unsigned v, unsigned l)
+{
+   assert(v && (l >> 1) != v);
+   _type[v] = MERGED;
+   _fanin[v * 2] = l;
+}
+
+// Every reference to v now reads as literal l
+void
+CirAig::merge(unsigned v, unsigned l)
+{
+   if (_type[l >> 1] == MERGED) l = resolve(l);
+   assert(v && (l >> 1) != v);
+   for (unsigned i = 0, n = faninSize(v); i < n; ++i) unlink(v * 2 + i);
+   splice(v, l >> 1);
+   _type[v] = MERGED;
+   _fanin[v * 2] = l;
+}
+
+// v must not be referenced by any remaining gate
+void
+CirAig::remove(unsigned v)
+{
+   for (unsigned i = 0, n = faninSize(v); i < n; ++i) unlink(v * 2 + i);
+   _type[v] = NO_GATE;
+   _symbol.erase(v);
+}
+
+const string&
+CirAig::symbol(unsigned v) const
+{
+   static const string empty;
+   if (_symbol.empty()) return empty;
+   unordered_map<unsigned, string>::const_iterator it = _symbol.find(v);
+   return it == _symbol.end()? empty: it->second;
+}
+
+// Follow the forwarding chain and shorten it to one step
+unsigned
+CirAig::resolve(unsigned l) const
+{
+   unsigned r = l;
+   while (_type[r >> 1] == MERGED)
+      r = _fanin[(r >> 1) * 2] ^ (r & 1);
+   while (_type[l >> 1] == MERGED) {
+      unsigned& next = _fanin[(l >> 1) * 2];
+      unsigned n = next ^ (l & 1);
+      next = r ^ (l & 1);
+      l = n;
+   }
+   return r;
+}
+
+// Fanouts are first listed in ascending order of the fanout gates (a
+// gate reading the same variable twice appears twice); a merge appends
+// the fanouts of the merged gate to those of its replacement.
+void
+CirAig::buildFanouts()
+{
+   const unsigned n = size();
+   _foHead.assign(n, NO_FANOUT);
+   _foNext.assign(n * 2, NO_FANOUT);
+   _foPrev.assign(n * 2, NO_FANOUT);
+   for (unsigned v = 0; v < n; ++v)
+      for (unsigned i = 0, m = faninSize(v); i < m; ++i)
+         link(v * 2 + i);
+}
+
+unsigned
+CirAig::fanoutSize(unsigned v) const
+{
+   unsigned n = 0;
+   for (unsigned s = firstFanout(v); s != NO_FANOUT; s = nextFanout(v, s))
+      ++n;
+   return n;
+}
+
+// Append fanin slot s to the fanout list of the variable it reads
+void
+CirAig::link(unsigned s)
+{
+   const unsigned v = lit(s >> 1, s & 1) >> 1, h = _foHead[v];
+   if (h == NO_FANOUT) {
+      _foHead[v] = _foNext[s] = _foPrev[s] = s;
+      return;
+   }
+   _foNext[_foPrev[h]] = s;
+   _foPrev[s] = _foPrev[h];
+   _foNext[s] = h;
+   _foPrev[h] = s;
+}
+
+void
+CirAig::unlink(unsigned s)
+{
+   const unsigned v = lit(s >> 1, s & 1) >> 1;
+   if (_foNext[s] == s) {
+      _foHead[v] = NO_FANOUT;
+      return;
+   }
+   _foNext[_foPrev[s]] = _foNext[s];
+   _foPrev[_foNext[s]] = _foPrev[s];
+   if (_foHead[v] == s) _foHead[v] = _foNext[s];
+}
+
+// Move the whole fanout list of "from" to the end of that of "to"
+void
+CirAig::splice(unsigned from, unsigned to)
+{
+   const unsigned hf = _foHead[from], ht = _foHead[to];
+   if (hf == NO_FANOUT) return;
+   _foHead[from] = NO_FANOUT;
+   if (ht == NO_FANOUT) {
+      _foHead[to] = hf;
+      return;
+   }
+   const unsigned tf = _foPrev[hf], tt = _foPrev[ht];
+   _foNext[tt] = hf;
+   _foPrev[hf] = tt;
+   _foNext[tf] = ht;
+   _foPrev[ht] = tf;
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+  FileName     [ cirAig.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the compact AIG store ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_AIG_H
+#define CIR_AIG_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "cirDef.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   class CirAig
+//------------------------------------------------------------------------
+// Structure-of-arrays netlist indexed by variable (gate ID). Fanins are
+// AIGER literals (var * 2 + complement), two per variable, so an AND node
+// costs 8 bytes plus its type and line number. A PO uses only its first
+// literal. Symbols are kept in a sparse table.
+// merge(v, l) turns v into a forwarding entry to literal l instead of
+// rewiring the fanouts of v; lit() follows the forwarding and shortens it,
+// so a merge is O(1) no matter how large the fanout of v is.
+// The fanout lists are circular doubly linked lists through the fanin
+// slots (v * 2 + i), built by buildFanouts() once the netlist is read.
+// merge() and remove() unlink the fanin slots of the gate and splice its
+// fanouts onto the replacement in O(1).
+class CirAig
+{
+public:
+   CirAig() {}
+   ~CirAig() {}
+
+   void init(unsigned vars);
+   unsigned size() const { return _type.size(); }
+
+   GateType type(unsigned v) const { return GateType(_type[v]); }
+   bool exists(unsigned v) const { return _type[v] < TOT_GATE; }
+   unsigned line(unsigned v) const { return _line[v]; }
+   unsigned faninSize(unsigned v) const {
+      return _type[v] == AIG_GATE? 2: _type[v] == PO_GATE? 1: 0;
+   }
+   // the i-th fanin literal of v, with merged gates resolved
+   unsigned lit(unsigned v, size_t i) const {
+      unsigned& l = _fanin[v * 2 + i];
+      if (_type[l >> 1] == MERGED) l = resolve(l);
+      return l;
+   }
+
+   void setConst();
+   void setPI(unsigned v, unsigned line);
+   void setPO(unsigned v, unsigned line, unsigned l);
+   void setAig(unsigned v, unsigned line, unsigned l0, unsigned l1);
+   void setUndef(unsigned v);
+   // v reads as literal l; like merge(), but before buildFanouts()
+   void setMerged(unsigned v, unsigned l);
+   void merge(unsigned v, unsigned l);
+   void remove(unsigned v);
+
+   const string& symbol(unsigned v) const;
+   void setSymbol(unsigned v, const string& s) { _symbol[v] = s; }
+
+   // fanouts of v as fanin slots (fanout var * 2 + fanin index):
+   // for (s = firstFanout(v); s != NO_FANOUT; s = nextFanout(v, s))
+   static const unsigned NO_FANOUT = ~0u;
+   void buildFanouts();
+   unsigned fanoutSize(unsigned v) const;
+   bool singleFanout(unsigned v) const {
+      return _foHead[v] != NO_FANOUT && _foNext[_foHead[v]] == _foHead[v];
+   }
+   unsigned firstFanout(unsigned v) const { return _foHead[v]; }
+   unsigned nextFanout(unsigned v, unsigned s) const {
+      return _foNext[s] == _foHead[v]? NO_FANOUT: _foNext[s];
+   }
+
+private:
+   // _type values beyond GateType
+   enum { NO_GATE = TOT_GATE, MERGED = TOT_GATE + 1 };
+
+   vector<unsigned char>              _type;
+   vector<unsigned>                   _line;
+   mutable vector<unsigned>           _fanin;
+   unordered_map<unsigned, string>    _symbol;
+
+   vector<unsigned>                   _foHead;   // per variable
+   vector<unsigned>                   _foNext;   // per fanin slot
+   vector<unsigned>                   _foPrev;
+
+   unsigned resolve(unsigned l) const;
+   void link(unsigned s);
+   void unlink(unsigned s);
+   void splice(unsigned from, unsigned to);
+};
+
+#endif // CIR_AIG_H
@@ -54,7 +54,7 @@ enum CirCmdState
 static CirCmdState curCmd = CIRINIT;
 
 //----------------------------------------------------------------------
-//    CIRRead <(string fileName)> [-Replace]
+//    CIRRead <(string fileName)> [-Replace] [-Strash]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirReadCmd::exec(const string& option)
@@ -66,13 +66,17 @@ CirReadCmd::exec(const string& option)
    if (options.empty())
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
-   bool doReplace = false;
+   bool doReplace = false, doStrash = false;
    string fileName;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Replace", options[i], 2) == 0) {
          if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
          doReplace = true;
       }
+      else if (myStrNCmp("-Strash", options[i], 2) == 0) {
+         if (doStrash) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doStrash = true;
+      }
       else {
          if (fileName.size())
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
@@ -93,7 +97,7 @@ CirReadCmd::exec(const string& option)
    }
    cirMgr = new CirMgr;
 
-   if (!cirMgr->readCircuit(fileName)) {
+   if (!cirMgr->readCircuit(fileName, doStrash)) {
       curCmd = CIRINIT;
       delete cirMgr; cirMgr = 0;
       return CMD_EXEC_ERROR;
@@ -107,7 +111,7 @@ CirReadCmd::exec(const string& option)
 void
 CirReadCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRRead <(string fileName)> [-Replace]" << endl;
+   os << "Usage: CIRRead <(string fileName)> [-Replace] [-Strash]" << endl;
 }
 
 void
@@ -376,6 +380,8 @@ CirStrashCmd::help() const
 //----------------------------------------------------------------------
 //    CIRSIMulate <-Random | -File <string patternFile>>
 //                [-Output (string logFile)]
+//                [-SIMD <auto | scalar | avx2 | avx512>]
+//                [-Thread <(size_t threads)>]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirSimCmd::exec(const string& option)
@@ -390,7 +396,10 @@ CirSimCmd::exec(const string& option)
 
    ifstream patternFile;
    ofstream logFile;
-   bool doRandom = false, doFile = false, doLog = false;
+   bool doRandom = false, doFile = false, doLog = false, doSimd = false;
+   bool doThread = false;
+   SimKernel kernel = SIM_AUTO;
+   int threads = 1;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Random", options[i], 2) == 0) {
          if (doRandom || doFile)
@@ -417,6 +426,31 @@ CirSimCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
          doLog = true;
       }
+      else if (myStrNCmp("-SIMD", options[i], 5) == 0) {
+         if (doSimd)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         int k = SIM_AUTO;
+         for (; k < SIM_KERNEL_TOT; ++k) {
+            string str = CirSimEngine::kernelStr(SimKernel(k));
+            if (myStrNCmp(str, options[i], str.size()) == 0) break;
+         }
+         if (k == SIM_KERNEL_TOT)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         kernel = SimKernel(k);
+         doSimd = true;
+      }
+      else if (myStrNCmp("-Thread", options[i], 2) == 0) {
+         if (doThread)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], threads) || threads < 1 ||
+             threads > (int)SIM_MAX_THREADS)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doThread = true;
+      }
       else
          return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
@@ -424,6 +458,14 @@ CirSimCmd::exec(const string& option)
    if (!doRandom && !doFile)
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
+   if (doSimd && !cirMgr->setSimKernel(kernel)) {
+      cerr << "Error: SIMD kernel \"" << CirSimEngine::kernelStr(kernel)
+           << "\" is not supported by this CPU!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if (doThread)
+      cirMgr->setSimThreads(threads);
+
    assert (curCmd != CIRINIT);
    if (doLog)
       cirMgr->setSimLog(&logFile);
@@ -443,7 +485,9 @@ void
 CirSimCmd::usage(ostream& os) const
 {
    os << "Usage: CIRSIMulate <-Random | -File <string patternFile>>\n"
-      << "                   [-Output (string logFile)]" << endl;
+      << "                   [-Output (string logFile)]\n"
+      << "                   [-SIMD <auto | scalar | avx2 | avx512>]\n"
+      << "                   [-Thread <(size_t threads)>]" << endl;
 }
 
 void
@@ -454,7 +498,7 @@ CirSimCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRFraig
+//    CIRFraig [-Thread <(size_t threads)>] [-Justify]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirFraigCmd::exec(const string& option)
@@ -467,14 +511,32 @@ CirFraigCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (!options.empty())
-      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+   int threads = 0;
+   bool justify = false;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Thread", options[i], 2) == 0) {
+         if (threads)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], threads) || threads < 1 ||
+             threads > (int)FRAIG_MAX_THREADS)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Justify", options[i], 2) == 0) {
+         if (justify)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         justify = true;
+      }
+      else
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
 
    if (curCmd != CIRSIMULATE) {
       cerr << "Error: circuit is not yet simulated!!" << endl;
       return CMD_EXEC_ERROR;
    }
-   cirMgr->fraig();
+   cirMgr->fraig(threads? threads: 1, justify);
    curCmd = CIRFRAIG;
 
    return CMD_EXEC_DONE;
@@ -483,7 +545,7 @@ CirFraigCmd::exec(const string& option)
 void
 CirFraigCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRFraig" << endl;
+   os << "Usage: CIRFraig [-Thread <(size_t threads)>] [-Justify]" << endl;
 }
 
 void
@@ -511,9 +573,10 @@ CirWriteCmd::exec(const string& option)
       cirMgr->writeAag(cout);
       return CMD_EXEC_DONE;
    }
-   bool hasFile = false;
+   bool hasFile = false, binary = false;
    int gateId;
    CirGate *thisGate = NULL;
+   string fileName;
    ofstream outfile;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Output", options[i], 2) == 0) {
@@ -521,13 +584,16 @@ CirWriteCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
-         outfile.open(options[i].c_str(), ios::out);
-         if (!outfile)
-            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[1]);
+         fileName = options[i];
          hasFile = true;
       }
+      else if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (binary || thisGate != NULL)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         binary = true;
+      }
       else if (myStr2Int(options[i], gateId) && gateId >= 0) {
-         if (thisGate != NULL)
+         if (thisGate != NULL || binary)
             return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
          thisGate = cirMgr->getGate(gateId);
          if (!thisGate) {
@@ -541,8 +607,17 @@ CirWriteCmd::exec(const string& option)
       }
       else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
+   if (hasFile) {
+      outfile.open(fileName.c_str(), binary? ios::out | ios::binary: ios::out);
+      if (!outfile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+   }
 
-   if (!thisGate) {
+   if (binary) {
+      if (hasFile) cirMgr->writeAig(outfile);
+      else cirMgr->writeAig(cout);
+   }
+   else if (!thisGate) {
       assert (hasFile);
       cirMgr->writeAag(outfile);
    }
@@ -555,13 +630,14 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [(int gateId) | -Binary][-Output (string aagFile)]"
+      << endl;
 }
 
 void
 CirWriteCmd::help() const
 {
    cout << setw(15) << left << "CIRWrite: "
-        << "write the netlist to an ASCII AIG file (.aag)\n";
+        << "write the netlist to an ASCII (.aag) or binary (.aig) AIG file\n";
 }
 
@@ -19,11 +19,31 @@ using namespace std;
 class CirGate;
 class CirMgr;
 class SatSolver;
+class CirThreadPool;
 
 typedef vector<CirGate*>           GateList;
 typedef vector<unsigned>           IdList;
 
 const int SIZE_T = sizeof(size_t) * 8;
+// #words simulated per gate in one pass of randomSim()/fileSim()
+const size_t SIM_WORDS = 16;
+// upper bound of the simulation buffer (#words) for huge netlists
+const size_t SIM_MAX_VALUES = (size_t)1 << 26;
+// a level narrower than (#threads * SIM_LEVEL_GRAIN) gates is not split
+const size_t SIM_LEVEL_GRAIN = 256;
+// upper bound of "cirsim -Thread"
+const size_t SIM_MAX_THREADS = 256;
+// SAT budget of one equivalence query in fraig(); a pair that runs out
+// is left for the next round
+const long long FRAIG_CONF_BUDGET = 10000;
+const long long FRAIG_PROP_BUDGET = 20000000;
+// conflict budget of a constant candidate in CirMgr::fraigConst(); one that
+// runs out is proven among the pairs of the round instead
+const long long FRAIG_CONST_BUDGET = 10;
+// fraigConst() stops after this many candidates in a row run out
+const unsigned FRAIG_CONST_GIVEUP = 8;
+// upper bound of "cirfraig -Thread"
+const size_t FRAIG_MAX_THREADS = 256;
 
 enum GateType
 {
@@ -42,4 +62,14 @@ enum SimType
    EVENT_DRIVEN    = 1,
 };
 
+enum SimKernel
+{
+   SIM_AUTO   = 0,
+   SIM_SCALAR = 1,
+   SIM_AVX2   = 2,
+   SIM_AVX512 = 3,
+
+   SIM_KERNEL_TOT
+};
+
 #endif // CIR_DEF_H
@@ -0,0 +1,263 @@
+/****************************************************************************
+  FileName     [ cirFec.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the FEC group partition ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <climits>
+#include <algorithm>
+#include "cirFec.h"
+#include "cirGate.h"
+#include "cirSimEngine.h"
+
+using namespace std;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Signatures are canonicalized by the first pattern so that complemented
+// gates fall into the same group
+static inline size_t
+sigHash(const size_t* s, size_t words)
+{
+   const size_t inv = -(s[0] & 1);
+   size_t h = 0;
+   for (size_t k = 0; k < words; ++k)
+      h = h * 10007 + (s[k] ^ inv);
+   return h;
+}
+
+static inline bool
+sigEqual(const size_t* a, const size_t* b, size_t words)
+{
+   const size_t inv = -((a[0] ^ b[0]) & 1);
+   for (size_t k = 0; k < words; ++k)
+      if ((a[k] ^ b[k]) != inv) return false;
+   return true;
+}
+
+/*****************************************/
+/*   class CirFecGrps member functions   */
+/*****************************************/
+void
+CirFecGrps::init(const GateList& gates)
+{
+   clear();
+   if (gates.size() < 2) return;
+   _members = gates;
+   _begin.push_back(0);
+   _end.push_back(gates.size());
+   setGrps();
+}
+
+void
+CirFecGrps::clear()
+{
+   for (size_t g = 0, ng = size(); g < ng; ++g)
+      for (size_t i = _begin[g], n = _end[g]; i < n; ++i)
+         if (_members[i]) _members[i]->setGrp(0, 0);
+   _members.clear();
+   _begin.clear();
+   _end.clear();
+}
+
+CirGate*
+CirFecGrps::head(size_t g) const
+{
+   for (size_t i = _begin[g], n = _end[g]; i < n; ++i)
+      if (_members[i]) return _members[i];
+   return 0;
+}
+
+void
+CirFecGrps::remove(CirGate* g)
+{
+   if (!g->fecGrp()) return;
+   assert(_members[g->grpPos()] == g);
+   _members[g->grpPos()] = 0;
+   g->setGrp(0, 0);
+}
+
+// The groups are read from the old member array and laid out again in
+// the new one, so holes and the ranges left by the splits of a few
+// groups are squeezed out.
+void
+CirFecGrps::refine(const CirSimEngine& engine, size_t words)
+{
+   if (empty()) return;
+   _old.swap(_members);
+   _members.resize(_old.size());
+   _newBegin.clear();
+   _newEnd.clear();
+   size_t out = 0;
+   for (size_t g = 0, ng = size(); g < ng; ++g) {
+      if (gather(_old, g) < 2) continue;
+      // most groups survive a round as a whole
+      if (split(engine, words) == 1) emit(out);
+      else emitSplit(out);
+   }
+   _members.resize(out);
+   _begin.swap(_newBegin);
+   _end.swap(_newEnd);
+   setGrps();
+}
+
+// The groups are split from the last one down, so a group that is gone
+// can be replaced by the last one, which is done already.
+void
+CirFecGrps::refine(const CirSimEngine& engine, size_t words,
+                   const vector<unsigned>& grps)
+{
+   _grps.assign(grps.begin(), grps.end());
+   sort(_grps.begin(), _grps.end());
+   _grps.erase(unique(_grps.begin(), _grps.end()), _grps.end());
+   for (size_t k = _grps.size(); k-- > 0; ) {
+      const size_t g = _grps[k];
+      size_t m = gather(_members, g);
+      if (m >= 2 && split(engine, words) == 1) continue;
+      size_t out = _begin[g];
+      _newBegin.clear();
+      _newEnd.clear();
+      if (m >= 2) emitSplit(out);
+      if (_newBegin.empty()) { removeGrp(g); continue; }
+      for (size_t j = 0, n = _newBegin.size(); j < n; ++j) {
+         if (j) { _begin.push_back(_newBegin[j]); _end.push_back(_newEnd[j]); }
+         else { _begin[g] = _newBegin[j]; _end[g] = _newEnd[j]; }
+         const size_t id = j? size(): g + 1;
+         for (size_t i = _newBegin[j], e = _newEnd[j]; i < e; ++i)
+            _members[i]->setGrp(id, i);
+      }
+   }
+}
+
+void
+CirFecGrps::compact()
+{
+   if (empty()) return;
+   _old.swap(_members);
+   _members.resize(_old.size());
+   _newBegin.clear();
+   _newEnd.clear();
+   size_t out = 0;
+   for (size_t g = 0, ng = size(); g < ng; ++g)
+      if (gather(_old, g) >= 2) emit(out);
+   _members.resize(out);
+   _begin.swap(_newBegin);
+   _end.swap(_newEnd);
+   setGrps();
+}
+
+// Copy the live members of group g in "from" to _tmp. Gates that are
+// removed or no longer simulated (left dangling by merges) leave the
+// group, and so does the last member of a group that shrinks to one.
+size_t
+CirFecGrps::gather(const GateList& from, size_t g)
+{
+   _tmp.clear();
+   for (size_t i = _begin[g], n = _end[g]; i < n; ++i) {
+      CirGate* x = from[i];
+      if (!x) continue;
+      if (!x->inDfs() && x->getType() != CONST_GATE) x->setGrp(0, 0);
+      else _tmp.push_back(x);
+   }
+   if (_tmp.size() == 1) _tmp[0]->setGrp(0, 0);
+   return _tmp.size();
+}
+
+// Hash the members in _tmp by the first "words" words of their values;
+// _sub[j] is the subgroup of _tmp[j] and _cnt[k] the size of subgroup k.
+// Returns the number of subgroups, and 1 without filling them in if all
+// the members agree.
+size_t
+CirFecGrps::split(const CirSimEngine& engine, size_t words)
+{
+   const size_t m = _tmp.size();
+   const size_t* s0 = engine[_tmp[0]->getID()];
+   size_t j = 1;
+   while (j < m && sigEqual(s0, engine[_tmp[j]->getID()], words)) ++j;
+   if (j == m) return 1;
+
+   size_t cap = 4;
+   while (cap < 2 * m) cap <<= 1;
+   _table.assign(cap, 0);
+   _sub.resize(m);
+   _cnt.clear();
+   _rep.clear();
+   for (j = 0; j < m; ++j) {
+      const size_t* s = engine[_tmp[j]->getID()];
+      size_t h = sigHash(s, words) & (cap - 1);
+      unsigned k;
+      for (;; h = (h + 1) & (cap - 1)) {
+         if (!_table[h]) {
+            k = _cnt.size();
+            _table[h] = k + 1;
+            _cnt.push_back(0);
+            _rep.push_back(j);
+            break;
+         }
+         k = _table[h] - 1;
+         if (sigEqual(engine[_tmp[_rep[k]]->getID()], s, words)) break;
+      }
+      _sub[j] = k;
+      ++_cnt[k];
+   }
+   return _cnt.size();
+}
+
+void
+CirFecGrps::emit(size_t& out)
+{
+   _newBegin.push_back(out);
+   for (size_t j = 0, n = _tmp.size(); j < n; ++j)
+      _members[out++] = _tmp[j];
+   _newEnd.push_back(out);
+}
+
+// Subgroups are laid out in the order of their first members; _cnt[k]
+// becomes the next output slot of subgroup k
+void
+CirFecGrps::emitSplit(size_t& out)
+{
+   for (size_t k = 0, nk = _cnt.size(); k < nk; ++k) {
+      if (_cnt[k] < 2) { _cnt[k] = UINT_MAX; continue; }
+      unsigned c = _cnt[k];
+      _cnt[k] = out;
+      _newBegin.push_back(out);
+      out += c;
+      _newEnd.push_back(out);
+   }
+   for (size_t j = 0, m = _tmp.size(); j < m; ++j) {
+      unsigned k = _sub[j];
+      if (_cnt[k] == UINT_MAX) { // singleton
+         _tmp[j]->setGrp(0, 0);
+         continue;
+      }
+      _members[_cnt[k]++] = _tmp[j];
+   }
+}
+
+// Group g has no members left; the last group takes its number
+void
+CirFecGrps::removeGrp(size_t g)
+{
+   const size_t last = size() - 1;
+   if (g != last) {
+      _begin[g] = _begin[last];
+      _end[g] = _end[last];
+      for (size_t i = _begin[g], n = _end[g]; i < n; ++i)
+         if (_members[i]) _members[i]->setGrp(g + 1, i);
+   }
+   _begin.pop_back();
+   _end.pop_back();
+}
+
+void
+CirFecGrps::setGrps()
+{
+   for (size_t g = 0, ng = size(); g < ng; ++g)
+      for (size_t i = _begin[g], n = _end[g]; i < n; ++i)
+         _members[i]->setGrp(g + 1, i);
+}
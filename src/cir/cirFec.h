@@ -0,0 +1,87 @@
+/****************************************************************************
+  FileName     [ cirFec.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the FEC group partition ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_FEC_H
+#define CIR_FEC_H
+
+#include <vector>
+#include "cirDef.h"
+
+using namespace std;
+
+class CirSimEngine;
+
+//------------------------------------------------------------------------
+//   class CirFecGrps
+//------------------------------------------------------------------------
+// All FEC groups share one member array; group g occupies
+// [_begin[g], _end[g]). A split keeps the relative order of the members,
+// so the members of a group stay in ascending ID order and the first one
+// is the group head. The groups themselves are not ordered;
+// CirMgr::printFECPairs() walks the gates by ID instead of sorting them.
+// A gate knows its group through CirGate::fecGrp() (group + 1, 0 for
+// none) and its slot in the member array. remove() clears the slot and
+// the hole is squeezed out by the next refine() or compact().
+// Refining a few groups splits each of them within its own range; the
+// first subgroup keeps the group number and the others are numbered
+// after the last group, so the other groups are not touched.
+class CirFecGrps
+{
+public:
+   CirFecGrps() {}
+   ~CirFecGrps() {}
+
+   // "gates" must be in ascending ID order
+   void init(const GateList& gates);
+   void clear();
+
+   size_t size() const { return _begin.size(); }
+   bool empty() const { return size() == 0; }
+
+   // members of group g; removed members are 0
+   CirGate* const* begin(size_t g) const { return &_members[_begin[g]]; }
+   CirGate* const* end(size_t g) const { return &_members[_end[g]]; }
+   CirGate* head(size_t g) const;
+
+   void remove(CirGate* g);
+   // split every group by the first "words" words of the simulation
+   // values; complemented signatures stay in the same group
+   void refine(const CirSimEngine& engine, size_t words);
+   // split only the groups in "grps", the ones whose members may have
+   // changed their values; duplicates are allowed
+   void refine(const CirSimEngine& engine, size_t words,
+               const vector<unsigned>& grps);
+   // drop removed members, gates no longer in the DFS list and groups
+   // with less than two members
+   void compact();
+
+private:
+   GateList          _members;
+   vector<size_t>    _begin;
+   vector<size_t>    _end;
+
+   // scratch buffers of refine(), kept to avoid reallocation
+   GateList          _old;     // member array being laid out again
+   vector<size_t>    _newBegin;
+   vector<size_t>    _newEnd;
+   vector<unsigned>  _grps;
+   GateList          _tmp;
+   vector<unsigned>  _sub;     // subgroup of each member
+   vector<unsigned>  _cnt;     // #members of each subgroup
+   vector<unsigned>  _rep;     // first member of each subgroup
+   vector<unsigned>  _table;   // signature hash table (subgroup + 1)
+
+   size_t gather(const GateList& from, size_t g);
+   size_t split(const CirSimEngine& engine, size_t words);
+   void emit(size_t& out);
+   void emitSplit(size_t& out);
+   void removeGrp(size_t g);
+   void setGrps();
+};
+
+#endif // CIR_FEC_H
@@ -7,10 +7,13 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <atomic>
+#include <algorithm>
 #include "cirMgr.h"
 #include "cirGate.h"
-#include "sat.h"
-#include "myHashMap.h"
+#include "cirProver.h"
+#include "cirThread.h"
+#include "cirStrash.h"
 #include "util.h"
 
 using namespace std;
@@ -25,6 +28,13 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// a candidate pair of parFraig(): a == b (or a == !b if inv)
+struct FraigPair
+{
+   unsigned    a, b;
+   bool        inv;
+   int         result;   // of CirProver::prove()
+};
 
 /*******************************************/
 /*   Public member functions about fraig   */
@@ -34,40 +44,45 @@ using namespace std;
 void
 CirMgr::strash()
 {
-   HashMap<HashKey, CirGate*> hash(getHashSize(_dfsList.size()));
-   unsigned id;
+   CirStrashTable hash;
+   hash.init(_dfsList.size());
    for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
       if (_dfsList[i]->getType() != AIG_GATE) continue;
 
-      id = _dfsList[i]->getID();
-      HashKey k = getKey(_dfsList[i]);
-      CirGate *mergeGate;
-      if (hash.check(k, mergeGate)) { // merge
-         cout << "Strashing: " << mergeGate->getID() 
+      const unsigned id = _dfsList[i]->getID();
+      const unsigned mergeId =
+         hash.insert(_aig.lit(id, 0), _aig.lit(id, 1), id);
+      if (mergeId) { // merge
+         cout << "Strashing: " << mergeId
                << " merging " << id << "..." << endl;
-         change(_gateList[id], mergeGate);
-      }
-      else { // insert
-         hash.forceInsert(k, _dfsList[i]);
+         change(_gateList[id], _gateList[mergeId]);
       }
    }
    buildDfs();
 }
 
+// One prover serves the whole command: a gate gets its variable and CNF
+// the first time a proof needs it, and the clauses, including the learnt
+// ones, are kept across pairs and rounds. Each counterexample is expanded
+// into a word of its distance-1 neighbors and simulated at once, so the
+// candidates it breaks are not proven at all.
+// A round starts with the cheap constants (see fraigConst()), so the pairs
+// are then proven on the netlist they leave.
+// With more than one thread, the rounds are run by parFraig() instead.
 void
-CirMgr::fraig()
+CirMgr::fraig(size_t threads, bool justify)
 {
-   SatSolver solver;
+   if (threads > 1) { parFraig(threads, justify); return; }
+   CirProver prover(_aig, justify);
+   prover.init();
    vector<size_t> pattern(_header.i, 0);
    vector<GateList> mergeGate;
-   unsigned cnt = 0;
+   GateList undecided;
+   const vector<CirProver*> provers(1, &prover);
    unsigned fail = 0;
    size_t pre = 0, cur = 0;
    while (_fecGrps.size() && fail < 5) {
-      solver.reset();
-      solver.initialize();
-      setVar(solver);
-      constProofModel(solver);
+      fraigConst(provers, pattern);
       resetFraiged();
       for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
          if (_dfsList[i]->isFraiged()) continue;
@@ -75,61 +90,53 @@ CirMgr::fraig()
          if (!_dfsList[i]->fecGrp()) continue;
 
          _dfsList[i]->setFraiged(true);
-         GateList *list = _dfsList[i]->_fecGrp;
-         if (list->at(0)->getType() == CONST_GATE) {
-            bool inv = _dfsList[i]->getSimValue() != list->at(0)->getSimValue();
-            if (proveSat(_dfsList[i], list->at(0), solver, inv)) { // not equal
-               for (size_t k = 0, l = _PIOrder.size(); k < l; ++k) {
-                  pattern[k] <<= 1;
-                  pattern[k] += solver.getValue(_gateList[_PIOrder[k]]->getVar());
-               }
-               if (!(++cnt % SIZE_T)) { // resimulate
-                  for (size_t k = 0, l = _PIOrder.size(); k < l; ++k) {
-                     _gateList[_PIOrder[k]]->setSimValue(pattern[k]);
-                     pattern[k] = 0;
-                  }
-                  simulate();
-                  sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-                  setFecGrp();
-                  cout << "Updating by SAT... Total #FEC Group = " << _fecGrps.size() << endl;
-                  break;
-               }
-            }
-            else { // equal
+         size_t grp = _dfsList[i]->fecGrp() - 1;
+         CirGate* head = _fecGrps.head(grp);
+         if (head->getType() == CONST_GATE) {
+            bool inv = _dfsList[i]->getSimValue() != head->getSimValue();
+            // an undecided pair (sat < 0) is retried in the next round
+            int sat = proveSat(_dfsList[i], head, prover, inv);
+            if (sat > 0) // not equal
+               simCex(prover, _dfsList[i], head, pattern);
+            else if (sat == 0) { // equal
                GateList pair;
                pair.push_back(_dfsList[i]);
-               pair.push_back(list->at(0));
+               pair.push_back(head);
                mergeGate.push_back(pair);
             }
          }
          else {
-            for (size_t j = 0, m = list->size(); j < m; ++j) {
-               if (list->at(j) == _dfsList[i]) continue;
-               if (list->at(j)->isFraiged()) continue;
-               
-               bool inv = _dfsList[i]->getSimValue() != list->at(j)->getSimValue();
-               if (proveSat(_dfsList[i], list->at(j), solver, inv)) { // not equal
-                  for (size_t k = 0, l = _PIOrder.size(); k < l; ++k) {
-                     pattern[k] <<= 1;
-                     pattern[k] += solver.getValue(_gateList[_PIOrder[k]]->getVar());
+            // a counterexample splits the group; go over the new one but
+            // skip the pairs left undecided
+            bool split = true;
+            undecided.clear();
+            while (split && _dfsList[i]->fecGrp()) {
+               split = false;
+               grp = _dfsList[i]->fecGrp() - 1;
+               for (CirGate* const* it = _fecGrps.begin(grp),
+                    * const* e = _fecGrps.end(grp); it != e; ++it) {
+                  if (!*it || *it == _dfsList[i]) continue;
+                  if ((*it)->isFraiged()) continue;
+                  if (find(undecided.begin(), undecided.end(), *it) !=
+                      undecided.end()) continue;
+
+                  bool inv = _dfsList[i]->getSimValue() != (*it)->getSimValue();
+                  int sat = proveSat(_dfsList[i], *it, prover, inv);
+                  if (sat < 0) { // retried in the next round
+                     undecided.push_back(*it);
+                     continue;
                   }
-                  if (!(++cnt % SIZE_T)) { // resimulate
-                     for (size_t k = 0, l = _PIOrder.size(); k < l; ++k) {
-                        _gateList[_PIOrder[k]]->setSimValue(pattern[k]);
-                        pattern[k] = 0;
-                     }
-                     simulate();
-                     sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-                     setFecGrp();
-                     cout << "Updating by SAT... Total #FEC Group = " << _fecGrps.size() << endl;
+                  if (sat) { // not equal
+                     simCex(prover, _dfsList[i], *it, pattern);
+                     split = true;
                      break;
                   }
-               }
-               else { // equal
-                  GateList pair;
-                  pair.push_back(list->at(j));
-                  pair.push_back(_dfsList[i]);
-                  mergeGate.push_back(pair);
+                  else { // equal
+                     GateList pair;
+                     pair.push_back(*it);
+                     pair.push_back(_dfsList[i]);
+                     mergeGate.push_back(pair);
+                  }
                }
             }
          }
@@ -139,108 +146,294 @@ CirMgr::fraig()
          bool inv = mergeGate[i][0]->getSimValue() != mergeGate[i][1]->getSimValue();
          cout << "Fraig: " << mergeGate[i][1]->getID() << " merging "
             << (inv? "!": "") << mergeGate[i][0]->getID() << "..." << endl;
-         mergeGate[i][0]->deleteSelf();
+         _fecGrps.remove(mergeGate[i][0]);
+         // the loaded fanouts of the merged gate keep its variable
+         prover.addEq(mergeGate[i][0]->getID(), mergeGate[i][1]->getID(), inv);
          change(_gateList[mergeGate[i][0]->getID()], mergeGate[i][1], inv);
       }
       mergeGate.clear();
-      buildDfs();
-      // update fec group
-      vector<GateList*> tmp;
-      for (int i = (int)_fecGrps.size() - 1; i >= 0; --i) {
-         if (_fecGrps[i]->size() < 2) {
-            if (!_fecGrps[i]->empty()) _fecGrps[i]->at(0)->setGrp(0, 0);
-            delete _fecGrps[i];
-         }
-         else {
-            tmp.push_back(_fecGrps[i]);
-         }
-      }
-      _fecGrps.swap(tmp);
+      updateDfs();
+      // gates left dangling by the merges leave their groups
+      _fecGrps.compact();
       cout << "Updating by UNSAT... Total #FEC Group = " << _fecGrps.size() << endl;
-      
-      // resimulate after each run
-      if (cnt % SIZE_T) {
-         for (size_t k = 0, l = _PIOrder.size(); k < l; ++k) {
-            _gateList[_PIOrder[k]]->setSimValue(pattern[k]);
-            pattern[k] = 0;
-         }
-         cnt = 0;
-         simulate();
-         sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-         setFecGrp();
-         cout << "Updating by SAT... Total #FEC Group = " << _fecGrps.size() << endl;
-      }
+
       cur = _fecGrps.size();
       if (pre == cur) ++fail;
       else fail = 0;
       pre = cur;
    }
+   // the patched order is topological but may differ from a fresh DFS
+   buildDfs();
    resetFecGrps();
 }
 
 /********************************************/
 /*   Private member functions about fraig   */
 /********************************************/
-HashKey
-CirMgr::getKey(CirGate* g) const {
-   HashKey k(g->invert(0), g->invert(1), g->_fanin[0], g->_fanin[1]);
-   return k;
+// Prove the candidates of the constant group, in _dfsList order, on the
+// first prover with FRAIG_CONST_BUDGET conflicts each. A proven constant
+// is asserted in every prover right away, a unit at the top level for the
+// candidates after it, and the constants are merged at the end and
+// propagated through their fanouts. The candidates that run out of budget
+// are left to the pairs of the round, and so are all the rest once
+// FRAIG_CONST_GIVEUP do in a row: those usually need the equivalences
+// below them first. A candidate that the merges leave dangling leaves the
+// round as well; no PO reaches it, so it is left to "cirsweep".
+// Returns the number of constants found.
+size_t
+CirMgr::fraigConst(const vector<CirProver*>& provers, vector<size_t>& pattern)
+{
+   CirProver& p = *provers[0];
+   GateList found;
+   unsigned undecided = 0;
+   for (size_t i = 0, n = _dfsList.size();
+        i < n && undecided < FRAIG_CONST_GIVEUP; ++i) {
+      CirGate* g = _dfsList[i];
+      if (g->getType() != AIG_GATE || !g->fecGrp()) continue;
+      CirGate* head = _fecGrps.head(g->fecGrp() - 1);
+      if (head->getType() != CONST_GATE) continue;
+
+      const bool inv = g->getSimValue() != head->getSimValue();
+      int sat = proveSat(g, head, p, inv, FRAIG_CONST_BUDGET);
+      if (sat < 0) { ++undecided; continue; }
+      undecided = 0;
+      if (sat > 0) simCex(p, g, head, pattern);
+      else {
+         for (size_t t = 0, m = provers.size(); t < m; ++t)
+            provers[t]->addEq(g->getID(), head->getID(), inv);
+         found.push_back(g);
+      }
+   }
+   if (!found.empty()) mergeConst(found);
+   return found.size();
 }
 
-void
-CirMgr::setVar(SatSolver& s)
+// fraigConst() on the threads of "pool": they take the candidates in
+// _dfsList order, one at a time, and prove them on their own provers,
+// where a proven constant is asserted right away. A thread stops after
+// FRAIG_CONST_GIVEUP candidates in a row run out of budget. Once the
+// threads are done, the constants are asserted in every prover and the
+// counterexamples are simulated before the merges.
+size_t
+CirMgr::parFraigConst(CirThreadPool& pool, const vector<CirProver*>& provers,
+                      vector<vector<size_t> >& cex)
 {
+   CirGate* const0 = _gateList[0];
+   vector<FraigPair> cands;
    for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
-      if (_dfsList[i]->getType() == PO_GATE) _dfsList[i]->setVar(_dfsList[i]->_faninPtr[0]->getVar());
-      else _dfsList[i]->setVar(s.newVar());
+      CirGate* g = _dfsList[i];
+      if (g->getType() != AIG_GATE || !g->fecGrp()) continue;
+      if (_fecGrps.head(g->fecGrp() - 1) != const0) continue;
+      FraigPair q = { g->getID(), 0, g->getSimValue() != const0->getSimValue(),
+                      -1 };
+      cands.push_back(q);
+   }
+   if (cands.empty()) return 0;
+   atomic<size_t> next(0);
+   pool.run([&](size_t t) {
+      CirProver& p = *provers[t];
+      unsigned undecided = 0;
+      for (size_t k; undecided < FRAIG_CONST_GIVEUP &&
+           (k = next++) < cands.size(); ) {
+         FraigPair& q = cands[k];
+         q.result = p.prove(q.a, 0, q.inv, FRAIG_CONST_BUDGET);
+         if (q.result < 0) { ++undecided; continue; }
+         undecided = 0;
+         if (q.result == 0) { p.addEq(q.a, 0, q.inv); continue; }
+         cex[t].resize(cex[t].size() + _header.i);
+         p.expand(q.a, 0, _PIOrder, &cex[t][cex[t].size() - _header.i]);
+      }
+   });
+   // every candidate before "next" has been tried
+   const size_t tried = next < cands.size()? size_t(next): cands.size();
+   GateList found;
+   for (size_t k = 0; k < tried; ++k) {
+      const FraigPair& q = cands[k];
+      if (q.result) continue;
+      for (size_t t = 0, m = provers.size(); t < m; ++t)
+         provers[t]->addEq(q.a, 0, q.inv);
+      found.push_back(_gateList[q.a]);
    }
+   resimCex(cex);
+   if (!found.empty()) mergeConst(found);
+   return found.size();
 }
+
+// Merge the gates in "found", which every prover knows already, into
+// CONST0 and simplify their fanouts
 void
-CirMgr::constProofModel(SatSolver& s)
+CirMgr::mergeConst(const GateList& found)
 {
-   for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
-      if (_dfsList[i]->getType() != AIG_GATE) continue;
-
-      s.addAigCNF(_dfsList[i]->getVar(), 
-                  _dfsList[i]->_faninPtr[0]->getVar(), _dfsList[i]->invert(0),
-                  _dfsList[i]->_faninPtr[1]->getVar(), _dfsList[i]->invert(1));
+   CirGate* const0 = _gateList[0];
+   IdList fanouts;
+   for (size_t i = 0, n = found.size(); i < n; ++i) {
+      const unsigned id = found[i]->getID();
+      bool inv = found[i]->getSimValue() != const0->getSimValue();
+      cout << "Fraig: 0 merging " << (inv? "!": "") << id << "..." << endl;
+      for (unsigned s = _aig.firstFanout(id); s != CirAig::NO_FANOUT;
+           s = _aig.nextFanout(id, s))
+         fanouts.push_back(s / 2);
+      _fecGrps.remove(found[i]);
+      change(_gateList[id], const0, inv);
    }
+   simplifyFanouts(fanouts);
+   updateDfs();
+   // gates left dangling by the merges leave their groups
+   _fecGrps.compact();
+}
+
+// Simulate the distance-1 expansion of the counterexample of (a, b) at
+// once; "pattern" is a scratch buffer of one word per PI
+void
+CirMgr::simCex(CirProver& p, CirGate* a, CirGate* b, vector<size_t>& pattern)
+{
+   p.expand(a->getID(), b->getID(), _PIOrder, pattern.data());
+   for (size_t k = 0, l = _PIOrder.size(); k < l; ++k)
+      _simEngine.setInput(_PIOrder[k], 0, pattern[k]);
+   simulate(1, false, EVENT_DRIVEN);
+   cout << "Updating by SAT... Total #FEC Group = " << _fecGrps.size() << endl;
 }
 
-bool
-CirMgr::proveSat(CirGate * a, CirGate * b, SatSolver& s, const bool& inv)
+// Resimulate with the expanded counterexamples of the threads, one word
+// each and as many words per pass as the simulation rows hold
+void
+CirMgr::resimCex(vector<vector<size_t> >& cex)
 {
-   bool isSat;
-   if (b->getType() == CONST_GATE) { // if b is const 0, just prove a
-      s.assumeRelease();
-      s.assumeProperty(a->getVar(), !inv);
-      isSat = s.assumpSolve();
-      cout << "                                        " << char(13) << flush
-         << "Proving " << a->getID() << " = " << (inv? "!": "") << (inv? "1": "0")
-         << "..." << (isSat? "SAT": "UNSAT") << "!!" << char(13) << flush;
+   size_t w = 0;
+   for (size_t t = 0, nt = cex.size(); t < nt; ++t) {
+      for (size_t b = 0, m = cex[t].size(); b < m; b += _header.i) {
+         for (size_t k = 0, l = _PIOrder.size(); k < l; ++k)
+            _simEngine.setInput(_PIOrder[k], w, cex[t][b + k]);
+         if (++w == _simEngine.words()) {
+            simulate(w, false, EVENT_DRIVEN);
+            cout << "Updating by SAT... Total #FEC Group = " << _fecGrps.size() << endl;
+            w = 0;
+         }
+      }
+      cex[t].clear();
    }
-   else {
-      Var var = s.newVar();
-      s.addXorCNF(var, a->getVar(), 0, b->getVar(), inv);
-      s.assumeRelease();
-      s.assumeProperty(var, true);
-      isSat = s.assumpSolve();
-      cout << "                                        " << char(13) << flush
-         << "Proving (" << a->getID() << ", " << (inv? "!": "") << b->getID()
-         << ")..." << (isSat? "SAT": "UNSAT") << "!!" << char(13) << flush;
+   if (w) {
+      simulate(w, false, EVENT_DRIVEN);
+      cout << "Updating by SAT... Total #FEC Group = " << _fecGrps.size() << endl;
    }
-   if (!isSat) b->setFraiged(true);
+}
+
+// See CirProver::prove(); "b" is marked fraiged once proven equal
+int
+CirMgr::proveSat(CirGate * a, CirGate * b, CirProver& p, const bool& inv,
+                 long long conf)
+{
+   const char* result[] = { "UNDECIDED", "UNSAT", "SAT" };
+   int isSat = p.prove(a->getID(), b->getID(), inv, conf);
+   cout << "                                        " << char(13) << flush;
+   if (b->getType() == CONST_GATE)
+      cout << "Proving " << a->getID() << " = " << (inv? "!": "") << (inv? "1": "0")
+         << "..." << result[isSat + 1] << "!!" << char(13) << flush;
+   else
+      cout << "Proving (" << a->getID() << ", " << (inv? "!": "") << b->getID()
+         << ")..." << result[isSat + 1] << "!!" << char(13) << flush;
+   if (isSat == 0) b->setFraiged(true);
    return isSat;
 }
 
+// A round starts with parFraigConst() and then proves every member of
+// each FEC group against the member that comes first in _dfsList (or the
+// constant), so the pairs of a round are independent and the groups are
+// handed out to the threads one at a time.
+// Each thread has its own prover; the netlist is read-only while they run
+// and the merges and resimulation are done by the calling thread between
+// the rounds. Which thread proves a group varies from run to run, so the
+// counterexamples and the undecided pairs may vary as well.
 void
-CirMgr::resetFecGrps()
+CirMgr::parFraig(size_t threads, bool justify)
 {
-   for (size_t i = 0, n = _fecGrps.size(); i < n; ++i) {
-      if (_fecGrps[i]) delete _fecGrps[i];
+   CirThreadPool pool;
+   pool.resize(threads);
+   vector<CirProver*> provers(threads);
+   for (size_t t = 0; t < threads; ++t) {
+      provers[t] = new CirProver(_aig, justify);
+      provers[t]->init();
    }
-   _fecGrps.clear();
-   for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
-      _dfsList[i]->setGrp(0, 0);
+   // expanded counterexamples of each thread, _header.i words each
+   vector<vector<size_t> > cex(threads);
+   vector<FraigPair> pairs;
+   vector<size_t> grpBegin;
+   IdList pos(_aig.size(), 0);
+   unsigned fail = 0;
+   size_t pre = 0, cur = 0;
+   // resolve the forwarding literals, which lit() would otherwise rewrite
+   // from the threads, and number the gates in _dfsList order
+   auto resolve = [&]() {
+      for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
+         const unsigned id = _dfsList[i]->getID();
+         for (unsigned j = 0, m = _aig.faninSize(id); j < m; ++j)
+            _aig.lit(id, j);
+         pos[id] = i;
+      }
+   };
+   while (_fecGrps.size() && fail < 5) {
+      resolve();
+      if (parFraigConst(pool, provers, cex)) resolve();
+      pairs.clear();
+      grpBegin.assign(1, 0);
+      for (size_t g = 0, n = _fecGrps.size(); g < n; ++g) {
+         CirGate* rep = _fecGrps.head(g);
+         if (rep->getType() != CONST_GATE) {
+            for (CirGate* const* it = _fecGrps.begin(g),
+                 * const* e = _fecGrps.end(g); it != e; ++it)
+               if (*it && pos[(*it)->getID()] < pos[rep->getID()]) rep = *it;
+         }
+         for (CirGate* const* it = _fecGrps.begin(g),
+              * const* e = _fecGrps.end(g); it != e; ++it) {
+            if (!*it || *it == rep) continue;
+            FraigPair q = { (*it)->getID(), rep->getID(),
+                            (*it)->getSimValue() != rep->getSimValue(), -1 };
+            pairs.push_back(q);
+         }
+         if (pairs.size() > grpBegin.back()) grpBegin.push_back(pairs.size());
+      }
+      atomic<size_t> next(0);
+      pool.run([&](size_t t) {
+         CirProver& p = *provers[t];
+         for (size_t g; (g = next++) + 1 < grpBegin.size(); ) {
+            for (size_t k = grpBegin[g]; k < grpBegin[g + 1]; ++k) {
+               FraigPair& q = pairs[k];
+               q.result = p.prove(q.a, q.b, q.inv);
+               if (q.result <= 0) continue;
+               cex[t].resize(cex[t].size() + _header.i);
+               p.expand(q.a, q.b, _PIOrder, &cex[t][cex[t].size() - _header.i]);
+            }
+         }
+      });
+      // merge gate; an undecided pair is retried in the next round
+      for (size_t k = 0, n = pairs.size(); k < n; ++k) {
+         const FraigPair& q = pairs[k];
+         if (q.result) continue;
+         cout << "Fraig: " << q.b << " merging "
+            << (q.inv? "!": "") << q.a << "..." << endl;
+         _fecGrps.remove(_gateList[q.a]);
+         for (size_t t = 0; t < threads; ++t) provers[t]->addEq(q.a, q.b, q.inv);
+         change(_gateList[q.a], _gateList[q.b], q.inv);
+      }
+      updateDfs();
+      // gates left dangling by the merges leave their groups
+      _fecGrps.compact();
+      cout << "Updating by UNSAT... Total #FEC Group = " << _fecGrps.size() << endl;
+
+      resimCex(cex);
+      cur = _fecGrps.size();
+      if (pre == cur) ++fail;
+      else fail = 0;
+      pre = cur;
    }
+   for (size_t t = 0; t < threads; ++t) delete provers[t];
+   // the patched order is topological but may differ from a fresh DFS
+   buildDfs();
+   resetFecGrps();
+}
+
+void
+CirMgr::resetFecGrps()
+{
+   _fecGrps.clear();
 }
\ No newline at end of file
@@ -26,6 +26,12 @@ extern CirMgr *cirMgr;
 /**************************************/
 /*   class CirGate member functions   */
 /**************************************/
+CirGate*
+CirGate::fanin(size_t i) const
+{
+   return cirMgr->getGate(faninId(i));
+}
+
 void
 CirGate::reportGate() const
 {
@@ -53,11 +59,13 @@ CirGate::reportGate() const
    cout << output << endl;
    cout << "= FECs:";
    if (_fecGrp) {
-      for (size_t i = 0, n = _fecGrp->size(); i < n; ++i) {
-      if (_fecGrp->at(i) == this) continue;
+      const CirFecGrps& grps = cirMgr->getFecGrps();
+      for (CirGate* const* it = grps.begin(_fecGrp - 1),
+           * const* e = grps.end(_fecGrp - 1); it != e; ++it) {
+      if (!*it || *it == this) continue;
       cout << " ";
-      if (_fecGrp->at(i)->getSimValue() != _simValue) cout << "!";
-      cout << _fecGrp->at(i)->getID();
+      if ((*it)->getSimValue() != _simValue) cout << "!";
+      cout << (*it)->getID();
       }
    }
    cout << endl;
@@ -92,15 +100,15 @@ CirGate::faninRecursive(int level, int indent, bool inv)
    if (inv) { cout << "!"; }
    cout << getTypeStr() << " " << getID();
    if (level > 0) {
-      if (isVisited() && _faninPtr.size() > 0) {
+      if (isVisited() && faninSize() > 0) {
          cout << " (*)" << endl;
          return;
       }
       cout << endl;
       setMark(true);
-      for (size_t i = 0, n = _fanin.size(); i < n; ++i) {
-         bool v = (_invert[i]);
-         _faninPtr[i]->faninRecursive(level - 1, indent + 1, v);
+      for (size_t i = 0, n = faninSize(); i < n; ++i) {
+         const unsigned l = faninLit(i);
+         cirMgr->getGate(l >> 1)->faninRecursive(level - 1, indent + 1, l & 1);
       }
    }
    else { cout << endl; }
@@ -125,67 +133,44 @@ CirGate::fanoutRecursive(int level, int indent, bool inv)
    if (inv) { cout << "!"; }
    cout << getTypeStr() << " " << getID();
    if (level > 0) {
-      if (isVisited() && _fanoutPtr.size() > 0) {
+      if (isVisited() && fanoutSize() > 0) {
          cout << " (*)" << endl;
          return;
       }
       cout << endl;
       setMark(true);
-      for (size_t i = 0, n = _fanout.size(); i < n; ++i) {
-         bool v;
-         for (size_t j = 0, m = _fanoutPtr[i]->_faninPtr.size(); j < m; ++j) {
-            if (_fanoutPtr[i]->_faninPtr[j] == this) {
-               v = _fanoutPtr[i]->_invert[j];
-               break;
-            }
-         }
-         _fanoutPtr[i]->fanoutRecursive(level - 1, indent + 1, v);
+      // each fanout is a fanin slot: gate ID * 2 + fanin index
+      for (unsigned s = _aig->firstFanout(_ID); s != CirAig::NO_FANOUT;
+           s = _aig->nextFanout(_ID, s)) {
+         bool fInv = _aig->lit(s >> 1, s & 1) & 1;
+         cirMgr->getGate(s >> 1)->fanoutRecursive(level - 1, indent + 1, fInv);
       }
    }
    else { cout << endl; }
 }
 
-bool
-AIGGate::simulate(SimType type)
+/******************************************/
+/*   class CirGatePool member functions   */
+/******************************************/
+CirGatePool::~CirGatePool()
 {
-   if (type == EVENT_DRIVEN) {
-      if (isVisited()) return _lastSim;
-      setMark(true);
-      _lastSim = _faninPtr[0]->simulate(EVENT_DRIVEN) + _faninPtr[1]->simulate(EVENT_DRIVEN);
-      if (!_lastSim) return _lastSim;
-   }
-   size_t s0 = _faninPtr[0]->getSimValue();
-   size_t s1 = _faninPtr[1]->getSimValue();
-   if (invert(0)) s0 = ~s0;
-   if (invert(1)) s1 = ~s1;
-   
-   if (_simValue == (s0 & s1)) {
-      _lastSim = false;
-   }
-   else {
-      _simValue = s0 & s1;
-      _lastSim = true;
-   }
-   return _lastSim;
+   for (size_t i = 0, n = _chunks.size(); i < n; ++i) delete [] _chunks[i];
 }
 
-bool
-POGate::simulate(SimType type)
+void
+CirGatePool::reserve(size_t n)
 {
-   if (type == EVENT_DRIVEN) {
-      _lastSim = _faninPtr[0]->simulate(EVENT_DRIVEN);
-      if (!_lastSim) return _lastSim;
-   }
-   _simValue = _faninPtr[0]->getSimValue();
-   if (invert(0)) _simValue = ~_simValue;
-   return true;
+   if (size_t(_end - _next) >= n) return;
+   _chunks.push_back(new Slot[n]);
+   _next = _chunks.back();
+   _end = _next + n;
 }
 
+// Chunks beyond the reserved ones double up to 64K gates
 void
-CirGate::deleteSelf()
+CirGatePool::grow()
 {
-   if (!_fecGrp) return;
-   _fecGrp->erase(find(_fecGrp->begin(), _fecGrp->end(), this));
-   _fecGrp = 0;
-   _grpID = 0;
+   const size_t last = _chunks.empty()? 0: _end - _chunks.back();
+   const size_t cap = size_t(1) << 16;
+   reserve(!last? 1024: last < cap / 2? last * 2: cap);
 }
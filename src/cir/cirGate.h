@@ -13,8 +13,9 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <new>
 #include "cirDef.h"
-#include "sat.h"
+#include "cirAig.h"
 
 using namespace std;
 
@@ -25,17 +26,24 @@ class CirGate;
 //------------------------------------------------------------------------
 //   Define classes
 //------------------------------------------------------------------------
+// A CirGate is a view of one variable of CirAig: the structure (fanins,
+// fanouts, symbol and line number) is read from the store, while the gate
+// keeps only the per-gate states used by the algorithms.
+// The views are not created on demand: CirMgr::_gateList keeps one object
+// per variable, because the DFS list, the FEC groups and the commands hold
+// CirGate pointers. On x86-64 that is a 40-byte CirGatePool slot (vtable,
+// _aig, _ID, group slot, flags and _simValue) plus the 8-byte pointer, so
+// 48 bytes per variable on top of the 33 that CirAig takes.
 class CirGate
 {
 public:
-   CirGate() {}
-   CirGate(unsigned id, unsigned line): _ID(id), _line(line) {}
+   CirGate(const CirAig* aig, unsigned id): _aig(aig), _ID(id) {}
    virtual ~CirGate() {}
 
    // Basic access methods
    virtual string getTypeStr() const = 0;
    virtual GateType getType() const = 0;
-   unsigned getLineNo() const { return _line; }
+   unsigned getLineNo() const { return _aig->line(_ID); }
    unsigned getID() const { return _ID; }
    virtual bool isAig() const = 0;
 
@@ -45,97 +53,52 @@ public:
    void reportFanin(int level);
    void reportFanout(int level);
 
-   void setID(const unsigned& gid) { _ID = gid; }
-   unsigned getLine() const { return _line; }
-   void setLine(const unsigned& l) { _line = l; }
-
    bool isVisited() const { return _isVisited; }
    void setMark(bool flag) { _isVisited = flag; }
 
-   void addFanout(const unsigned& gid) { _fanout.push_back(gid); }
-   IdList::iterator findFanoutIndex(const unsigned& gid) {
-      return find(_fanout.begin(), _fanout.end(), gid);
-   }
-   int findFanoutIndex(CirGate* b) {
-      for (size_t i = 0, n = b->_fanoutPtr.size(); i < n; ++i) {
-         if (this == b->_fanoutPtr[i]) {
-            return i;
-         }
-      }
-      return -1;
-   }
-   void addFanin(const unsigned& gid) { _fanin.push_back(gid); }
-   IdList::iterator findFaninIndex(const unsigned& gid) {
-      return find(_fanin.begin(), _fanin.end(), gid);
-   }
-   int findFaninIndex(CirGate* b) {
-      for (size_t i = 0, n = b->_faninPtr.size(); i < n; ++i) {
-         if (this == b->_faninPtr[i]) {
-            return i;
-         }
-      }
-      return -1;
-   }
-
-   IdList   _fanout;
-   IdList   _fanin;
-   GateList _faninPtr;
-   GateList _fanoutPtr;
-
-   void setSymbol(string s) {
-      _s = s;
-   }
-   string getSymbol() const { return _s; }
-
-   bool invert(const int& i = 0) const { return _invert[i]; }
-   void inverseInvert(const int& i = 0) { _invert[i] = !_invert[i]; }
-   void addInvert(const bool& i) { _invert.push_back(i); }
-   vector<bool> getInvert() { return _invert; }
-   void deleteInvert(const int& i) { _invert.erase(_invert.begin() + i); }
+   // Structure in CirAig
+   unsigned faninSize() const { return _aig->faninSize(_ID); }
+   // the i-th fanin as an AIGER literal (ID * 2 + inverted)
+   unsigned faninLit(size_t i) const { return _aig->lit(_ID, i); }
+   unsigned faninId(size_t i) const { return faninLit(i) >> 1; }
+   bool invert(size_t i = 0) const { return faninLit(i) & 1; }
+   CirGate* fanin(size_t i) const;
+   unsigned fanoutSize() const { return _aig->fanoutSize(_ID); }
+   const string& getSymbol() const { return _aig->symbol(_ID); }
 
    bool inDfs() const { return _inDfs; }
    void setDfs(bool f) const { _inDfs = f; }
 
    void setSimValue(const size_t& v) { _simValue = v; }
    size_t getSimValue() { return _simValue; }
-   virtual bool simulate(SimType) = 0;
-   void setGrp(GateList* g, unsigned id) { _fecGrp = g, _grpID = id; }
-
-   Var getVar() { return _var; }
-   void setVar(const Var& v) { _var = v; }
+   // FEC group (index in CirFecGrps + 1, 0 for none) and member slot
+   unsigned fecGrp() const { return _fecGrp; }
+   unsigned grpPos() const { return _grpPos; }
+   void setGrp(unsigned g, unsigned pos) { _fecGrp = g, _grpPos = pos; }
 
    bool isFraiged() { return _isFraiged; }
    void setFraiged(const bool& f) { _isFraiged = f; }
 
-   GateList *   _fecGrp = 0;
-   GateList *fecGrp() { return _fecGrp; }
-   void deleteSelf();
-
 private:
-   unsigned int _ID;
-   unsigned int _line;
-   unsigned int _grpID = 0;
-   mutable bool _isVisited = false;
-   mutable bool _isReported = false;
-   mutable bool _inDfs = false;
-   mutable bool _isFraiged = false;
-   Var          _var;
+   const CirAig*  _aig;
+   unsigned int   _ID;
+   unsigned int   _fecGrp = 0;
+   unsigned int   _grpPos = 0;
+   mutable bool   _isVisited = false;
+   mutable bool   _inDfs = false;
+   mutable bool   _isFraiged = false;
 
    void faninRecursive(int level, int indent, bool inv);
    void fanoutRecursive(int level, int indent, bool inv);
 
-   string _s;
-
 protected:
-   vector<bool> _invert;
    size_t _simValue = 0;
-   mutable bool _lastSim = false;
 };
 
 class PIGate : public CirGate
 {
 public:
-   PIGate(unsigned id, unsigned line): CirGate(id, line) {}
+   PIGate(const CirAig* aig, unsigned id): CirGate(aig, id) {}
    ~PIGate() {}
 
    GateType getType() const { return PI_GATE; }
@@ -151,7 +114,6 @@ public:
    }
 
    bool isAig() const { return false; }
-   bool simulate(SimType) { return false; }
    
 private:
    
@@ -160,7 +122,7 @@ private:
 class POGate : public CirGate
 {
 public:
-   POGate(unsigned id, unsigned line): CirGate(id, line) {}
+   POGate(const CirAig* aig, unsigned id): CirGate(aig, id) {}
    ~POGate() {}
    
    GateType getType() const { return PO_GATE; }
@@ -169,9 +131,10 @@ public:
    void printGate() const {
       cout << getTypeStr() << "  " << getID() << " ";
 
-      if (_faninPtr[0]->getType() == UNDEF_GATE) cout << "*";
-      if (_invert[0]) cout << "!";
-      cout << _fanin[0];
+      const unsigned l = faninLit(0);
+      if (fanin(0)->getType() == UNDEF_GATE) cout << "*";
+      if (l & 1) cout << "!";
+      cout << (l >> 1);
       // symbol
       if (getSymbol().length() > 0) {
          cout << " (" << getSymbol() << ")";
@@ -180,7 +143,6 @@ public:
    }
 
    bool isAig() const { return false; }
-   bool simulate(SimType);   
 
 private:
 
@@ -189,7 +151,7 @@ private:
 class AIGGate : public CirGate
 {
 public:
-   AIGGate(unsigned id, unsigned line): CirGate(id, line) {}
+   AIGGate(const CirAig* aig, unsigned id): CirGate(aig, id) {}
    ~AIGGate() {}
 
    GateType getType() const { return AIG_GATE; }
@@ -198,16 +160,16 @@ public:
    void printGate() const {
       cout << getTypeStr() << " " << getID();
       for (int i = 0; i < 2; ++i) {
+         const unsigned l = faninLit(i);
          cout << " ";
-         if (_faninPtr[i]->getType() == UNDEF_GATE) cout << "*";
-         if (_invert[i]) cout << "!";
-         cout << _fanin[i];
+         if (fanin(i)->getType() == UNDEF_GATE) cout << "*";
+         if (l & 1) cout << "!";
+         cout << (l >> 1);
       }
       cout << endl;
    }
 
    bool isAig() const { return true; }
-   bool simulate(SimType);
 
 private:
 
@@ -216,7 +178,7 @@ private:
 class ConstGate : public CirGate
 {
 public:
-   ConstGate(): CirGate(0, 0) {}
+   ConstGate(const CirAig* aig): CirGate(aig, 0) {}
    ~ConstGate() {}
 
    GateType getType() const { return CONST_GATE; }
@@ -227,7 +189,6 @@ public:
    }
 
    bool isAig() const { return false; }
-   bool simulate(SimType) { return false; }
 
 private:
    
@@ -236,7 +197,7 @@ private:
 class UndefGate : public CirGate
 {
 public:
-   UndefGate(const unsigned& id): CirGate(id, 0) {}
+   UndefGate(const CirAig* aig, unsigned id): CirGate(aig, id) {}
    ~UndefGate() {}
 
    GateType getType() const { return UNDEF_GATE; }
@@ -245,10 +206,63 @@ public:
    void printGate() const {}
 
    bool isAig() const { return false; }
-   bool simulate(SimType) { return false; }
 
 private:
    
 };
 
+//------------------------------------------------------------------------
+//   class CirGatePool
+//------------------------------------------------------------------------
+// Storage of the gates of one CirMgr: the gates of all types share one
+// slot size, and they are carved out of large chunks instead of being
+// allocated one by one. A freed slot goes to a free list and is reused by
+// the next alloc(). The chunks are released with the pool, without
+// calling the destructors of the gates still in use, which do nothing.
+class CirGatePool
+{
+public:
+   CirGatePool(): _next(0), _end(0), _free(0) {}
+   ~CirGatePool();
+
+   // make the next n alloc() calls take consecutive slots
+   void reserve(size_t n);
+   template <class G, class... Args>
+   G* alloc(const Args&... args) { return new (slot()) G(args...); }
+   void free(CirGate* g) {
+      g->~CirGate();
+      Slot* s = reinterpret_cast<Slot*>(g);
+      s->next = _free;
+      _free = s;
+   }
+
+private:
+   union Slot
+   {
+      Slot*    next;      // when free
+      char     pi[sizeof(PIGate)];
+      char     po[sizeof(POGate)];
+      char     aig[sizeof(AIGGate)];
+      char     c0[sizeof(ConstGate)];
+      char     undef[sizeof(UndefGate)];
+      size_t   align;
+   };
+
+   vector<Slot*>  _chunks;
+   Slot*          _next;    // the unused part of the last chunk
+   Slot*          _end;
+   Slot*          _free;
+
+   void* slot() {
+      if (_free) {
+         Slot* s = _free;
+         _free = s->next;
+         return s;
+      }
+      if (_next == _end) grow();
+      return _next++;
+   }
+   void grow();
+};
+
 #endif // CIR_GATE_H
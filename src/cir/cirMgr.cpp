@@ -14,6 +14,10 @@
 #include <cassert>
 #include <cstring>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
@@ -147,187 +151,376 @@ parseError(CirParseError err)
    return false;
 }*/
 
+// AAG scanning helpers; the buffer is not NUL-terminated
+static inline const char*
+skipSpace(const char*& p, const char* end)
+{
+   while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+   return p;
+}
+
+static inline unsigned
+scanNum(const char*& p, const char* end)
+{
+   skipSpace(p, end);
+   unsigned n = 0;
+   while (p < end && unsigned(*p - '0') < 10) n = n * 10 + unsigned(*p++ - '0');
+   return n;
+}
+
+static inline void
+skipLine(const char*& p, const char* end)
+{
+   const char* nl = (const char*)memchr(p, '\n', end - p);
+   p = nl? nl + 1: end;
+}
+
+// binary AIGER: 7 bits per byte, least significant group first
+static inline unsigned
+scanDelta(const char*& p, const char* end)
+{
+   unsigned x = 0;
+   for (unsigned s = 0; p < end; s += 7) {
+      unsigned char c = *p++;
+      x |= unsigned(c & 0x7f) << s;
+      if (!(c & 0x80)) break;
+   }
+   return x;
+}
+
+static void
+writeDelta(ostream& os, unsigned x)
+{
+   for (; x & ~0x7fu; x >>= 7) os.put(char((x & 0x7f) | 0x80));
+   os.put(char(x));
+}
+
 /**************************************************************/
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
+// The file is memory-mapped and scanned in place; only the symbols and
+// the comment are copied out of the buffer.
+bool
+CirMgr::readCircuit(const string& fileName, bool strash)
+{
+   _strashOnRead = strash;
+   int fd = open(fileName.c_str(), O_RDONLY);
+   if (fd < 0) {
+      cerr << "Cannot open design \"" << fileName << "\"!!" << endl;
+      return false;
+   }
+   struct stat st;
+   void* map = MAP_FAILED;
+   if (fstat(fd, &st) == 0 && st.st_size > 0)
+      map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   bool ok;
+   if (map != MAP_FAILED) {
+      madvise(map, st.st_size, MADV_SEQUENTIAL);
+      const char* buf = (const char*)map;
+      ok = readAiger(buf, buf + st.st_size);
+      munmap(map, st.st_size);
+   }
+   else {
+      // not mappable (e.g. a pipe); read it into memory instead
+      string buf;
+      char chunk[1 << 16];
+      ssize_t n;
+      while ((n = read(fd, chunk, sizeof(chunk))) > 0) buf.append(chunk, n);
+      ok = readAiger(buf.data(), buf.data() + buf.size());
+   }
+   close(fd);
+   return ok;
+}
+
+// Both ASCII ("aag") and binary ("aig") AIGER. In the binary format the
+// PIs are implicit and the AIGs are delta-encoded; line numbers are
+// counted as if the file were the equivalent ASCII one.
 bool
-CirMgr::readCircuit(const string& fileName)
+CirMgr::readAiger(const char* p, const char* end)
 {
-   ifstream inf(fileName);
-   string x;
-   unsigned int line = 1;
-   getline(inf, x);
-   readHeader(x);
+   unsigned line = 1;
+   if (!readHeader(p, end)) return false;
+   const bool binary = _header.aag == "aig";
    ++line;
-   for (unsigned int i = 0; i < _header.i; ++i) {
-      getline(inf, x);
-      readPI(x, line);
+   for (unsigned i = 0; i < _header.i; ++i) {
+      if (binary) readPI(2 * (i + 1), line);
+      else {
+         readPI(scanNum(p, end), line);
+         skipLine(p, end);
+      }
       ++line;
    }
-   int PONo = 1;
-   for (unsigned int i = 0; i < _header.o; ++i) {
-      getline(inf, x);
-      readPO(x, line, PONo);
-      ++line; 
-      ++PONo;
+   for (unsigned i = 0; i < _header.o; ++i) {
+      readPO(scanNum(p, end), line, i + 1);
+      skipLine(p, end);
+      ++line;
    }
-   for (unsigned int i = 0; i < _header.a; ++i) {
-      getline(inf, x);
-      readAIG(x, line);
-      ++line; 
+   if (_strashOnRead) {
+      _strash.init(_header.a);
+      _waitHead.assign(_gateList.size(), 0);
+      _waitNext.assign(_gateList.size(), 0);
    }
+   for (unsigned i = 0, n = _header.a; i < n; ++i) {
+      if (binary) {
+         unsigned lhs = 2 * (_header.i + _header.l + i + 1);
+         unsigned rhs0 = lhs - scanDelta(p, end);
+         readAIG(lhs, rhs0, rhs0 - scanDelta(p, end), line);
+      }
+      else {
+         unsigned lhs = scanNum(p, end);
+         unsigned rhs0 = scanNum(p, end);
+         readAIG(lhs, rhs0, scanNum(p, end), line);
+         skipLine(p, end);
+      }
+      ++line;
+   }
+   if (_strashOnRead) flushAIGs();
 
    // connection
    buildConnection();
-   
+
    // symbol
-   while (getline(inf, x)) {
-      if (x == "c") { break; }
-      readSymbol(x);
-   }
-   // comment
-   while (getline(inf, x)) {
-      readComment(x);
+   while (p < end) {
+      if (*p == 'c' && (p + 1 == end || p[1] == '\n')) {
+         skipLine(p, end);
+         // comment
+         readComment(p, end);
+         break;
+      }
+      readSymbol(p, end);
    }
-
-   inf.close();
    return true;
 }
 
-void
-CirMgr::readHeader(const string& x) {
-   vector<string> tokens;
-   string token;
-   size_t n = myStrGetTok(x, token);
-   while (token.size()) {
-      tokens.push_back(token);
-      n = myStrGetTok(x, token, n);
-   }
-   assert(tokens.size() == 6);
-   _header.aag = tokens[0];
-   _header.m = stoi(tokens[1]);
-   _header.i = stoi(tokens[2]);
-   _header.l = stoi(tokens[3]);
-   _header.o = stoi(tokens[4]);
-   _header.a = stoi(tokens[5]);
+bool
+CirMgr::readHeader(const char*& p, const char* end) {
+   const char* tok = skipSpace(p, end);
+   while (p < end && !isspace(*p)) ++p;
+   _header.aag.assign(tok, p);
+   if (_header.aag != "aag" && _header.aag != "aig") {
+      cerr << "[ERROR] Line 1: Missing \"aag\"!!" << endl;
+      return false;
+   }
+   _header.m = scanNum(p, end);
+   _header.i = scanNum(p, end);
+   _header.l = scanNum(p, end);
+   _header.o = scanNum(p, end);
+   _header.a = scanNum(p, end);
+   skipLine(p, end);
 
    int arraySize = _header.m + _header.o + 1;
-   for (auto i = 0; i < arraySize; ++i) {
-      _gateList.push_back(NULL);
-   }
-   _gateList[0] = new ConstGate();
+   _aig.init(arraySize);
+   _aig.setConst();
+   _gateList.assign(arraySize, 0);
+   _gatePool.reserve(arraySize);
+   _gateList[0] = _gatePool.alloc<ConstGate>(&_aig);
+   _PIOrder.reserve(_header.i);
+   return true;
 }
 void
-CirMgr::readPI(const string& x, const unsigned& line) {
-   string token;
-   size_t n = myStrGetTok(x, token);
-   if (n != string::npos) {
-      // handle error
-      return;
-   }
-   int id = stoi(token) / 2;
-   _gateList[id] = new PIGate(id, line);
+CirMgr::readPI(unsigned lit, unsigned line) {
+   int id = lit / 2;
+   _aig.setPI(id, line);
+   _gateList[id] = _gatePool.alloc<PIGate>(&_aig, id);
    _PIOrder.push_back(id);
 }
 void
-CirMgr::readPO(const string& x, const unsigned& line, const unsigned& No) {
-   string token;
-   size_t n = myStrGetTok(x, token);
-   if (n != string::npos) {
-      // handle error
-      return;
-   }
+CirMgr::readPO(unsigned lit, unsigned line, unsigned No) {
    int id = _header.m + No;
-   _gateList[id] = new POGate(id, line);
-
-   int faninLId = stoi(token);
-   _gateList[id]->addFanin(faninLId / 2);
-   _gateList[id]->addInvert(faninLId % 2 == 1);
+   _aig.setPO(id, line, lit);
+   _gateList[id] = _gatePool.alloc<POGate>(&_aig, id);
 }
 void
-CirMgr::readAIG(const string& x, const unsigned& line) {
-   vector<string> tokens;
-   string token;
-   size_t n = myStrGetTok(x, token);
-   while (token.size()) {
-      tokens.push_back(token);
-      n = myStrGetTok(x, token, n);
-   }
-   assert(tokens.size() == 3);
-   
-   int id = stoi(tokens[0]) / 2;
-   _gateList[id] = new AIGGate(id, line);
-
-   for (int i = 1; i < 3; ++i) {
-      int faninLId = stoi(tokens[i]);
-      _gateList[id]->addFanin(faninLId / 2);
-      _gateList[id]->addInvert(faninLId % 2 == 1);
+CirMgr::readAIG(unsigned lhs, unsigned rhs0, unsigned rhs1, unsigned line) {
+   int id = lhs / 2;
+   _aig.setAig(id, line, rhs0, rhs1);
+   if (!_strashOnRead) _gateList[id] = _gatePool.alloc<AIGGate>(&_aig, id);
+   else {
+      _readStack.push_back(id);
+      strashAIGs();
    }
 }
+// Construct the AIGs in _readStack. An AIG whose fanin is not constructed
+// yet (an "aag" may define it later) waits in the list of that fanin
+// instead, so every AIG is folded with its fanins already canonical.
 void
-CirMgr::readSymbol(const string& x) {
-   string token;
-   myStrGetTok(x, token);
-
-   string mode = token.substr(0, 1);
-   size_t pos = x.find(' ');
-   string s = x.substr(pos + 1, x.length() - pos);
-
-   int num = stoi(token.substr(1, token.length() - 1));
-   if (mode == "i") {
-      int id = _PIOrder[num];
-      _gateList[id]->setSymbol(s);
+CirMgr::strashAIGs() {
+   while (!_readStack.empty()) {
+      const unsigned id = _readStack.back();
+      _readStack.pop_back();
+      bool ready = true;
+      for (size_t i = 0; ready && i < 2; ++i) {
+         const unsigned f = _aig.lit(id, i) / 2;
+         if (_gateList[f]) continue;
+         _waitNext[id] = _waitHead[f];
+         _waitHead[f] = id;
+         ready = false;
+      }
+      if (!ready) continue;
+      if (!foldAIG(id)) _gateList[id] = _gatePool.alloc<AIGGate>(&_aig, id);
+      for (unsigned w = _waitHead[id]; w; w = _waitNext[w])
+         _readStack.push_back(w);
+      _waitHead[id] = 0;
    }
-   else if (mode == "o") {
-      _gateList[_header.m + num + 1]->setSymbol(s);
+}
+// The AIGs still waiting read undefined gates; a cycle in the file is
+// left as it is
+void
+CirMgr::flushAIGs() {
+   for (size_t v = 1, n = _gateList.size(); v < n; ++v) {
+      if (!_waitHead[v] || _aig.exists(v)) continue;
+      _aig.setUndef(v);
+      _gateList[v] = _gatePool.alloc<UndefGate>(&_aig, v);
+      for (unsigned w = _waitHead[v]; w; w = _waitNext[w])
+         _readStack.push_back(w);
+      _waitHead[v] = 0;
+      strashAIGs();
+   }
+   for (size_t v = 1, n = _gateList.size(); v < n; ++v)
+      if (_aig.type(v) == AIG_GATE && !_gateList[v])
+         _gateList[v] = _gatePool.alloc<AIGGate>(&_aig, v);
+   _strash.clear();
+   IdList().swap(_waitHead);
+   IdList().swap(_waitNext);
+   IdList().swap(_readStack);
+}
+// Forward AIG "id" to an existing literal if the rules of optimize() or
+// strash() apply; no gate is constructed for it then
+bool
+CirMgr::foldAIG(unsigned id) {
+   const unsigned l0 = _aig.lit(id, 0), l1 = _aig.lit(id, 1);
+   unsigned l;
+   if (!simplifyAnd(l0, l1, l)) {
+      const unsigned v = _strash.insert(l0, l1, id);
+      if (!v) return false;
+      l = v * 2;
+   }
+   _aig.setMerged(id, l);
+   --_header.a;
+   return true;
+}
+// "[io]<num> <name>"; the name runs to the end of the line
+void
+CirMgr::readSymbol(const char*& p, const char* end) {
+   const char* eol = (const char*)memchr(p, '\n', end - p);
+   if (!eol) eol = end;
+   char mode = *p;
+   const char* q = p + 1;
+   unsigned num = scanNum(q, eol);
+   const char* sp = (const char*)memchr(p, ' ', eol - p);
+   if (sp) {
+      if (mode == 'i' && num < _PIOrder.size()) {
+         _aig.setSymbol(_PIOrder[num], string(sp + 1, eol));
+      }
+      else if (mode == 'o' && num < _header.o) {
+         _aig.setSymbol(_header.m + num + 1, string(sp + 1, eol));
+      }
    }
+   p = eol < end? eol + 1: end;
 }
+// the rest of the file, without its last newline
 void
-CirMgr::readComment(const string& x) {
-   if (!_comment.empty()) _comment += '\n';
-   _comment += x;
+CirMgr::readComment(const char* p, const char* end) {
+   if (p < end && end[-1] == '\n') --end;
+   _comment.assign(p, end);
 }
 void
 CirMgr::buildConnection() {
+   // fanins are already in _aig; only the undefined ones need a gate
    for (size_t i = 0, n = _gateList.size(); i < n; ++i) {
-      if (_gateList[i]) {
-         for (auto id = _gateList[i]->_fanin.begin(); id != _gateList[i]->_fanin.end(); ++id) {
-            if (!_gateList[*id]) { // undefine
-               _gateList[*id] = new UndefGate(*id);
-            }
-            _gateList[*id]->addFanout(_gateList[i]->getID());
-            _gateList[*id]->_fanoutPtr.push_back(_gateList[i]);
-            _gateList[i]->_faninPtr.push_back(_gateList[*id]);
+      if (!_gateList[i]) continue;
+      for (size_t j = 0, m = _aig.faninSize(i); j < m; ++j) {
+         unsigned id = _aig.lit(i, j) / 2;
+         if (!_gateList[id]) { // undefine
+            _aig.setUndef(id);
+            _gateList[id] = _gatePool.alloc<UndefGate>(&_aig, id);
          }
       }
    }
+   _aig.buildFanouts();
    buildDfs();
 }
+// _dfsRef[v] counts the references to v from the gates in _dfsList, so
+// that change() can tell which gates a merge leaves dangling.
 void
 CirMgr::buildDfs() {
    resetFlag();
    resetDFS();
    _dfsList.clear();
+   freeRemoved();
+   _simEngine.invalidate();
    for (size_t i = _header.m + 1, n = _gateList.size(); i < n; ++i) {
-      buildDfs(_gateList[i]);
+      dfs(_gateList[i], _dfsList);
+   }
+   _dfsRef.assign(_gateList.size(), 0);
+   for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
+      unsigned id = _dfsList[i]->getID();
+      _dfsList[i]->setDfs(true);
+      for (size_t j = 0, m = _aig.faninSize(id); j < m; ++j) {
+         unsigned f = _aig.lit(id, j) / 2;
+         ++_dfsRef[f];
+         // UNDEF gates are in DFS but not in the list
+         _gateList[f]->setDfs(true);
+      }
    }
 }
+// Patch _dfsList after merges instead of rebuilding it: change() has
+// already cleared the DFS flag of every gate left dangling, and a gate
+// is only ever replaced by an earlier gate or CONST0, so dropping the
+// dangling gates (and putting CONST0 in front) keeps it topological.
+// The order may differ from a fresh buildDfs().
+void
+CirMgr::updateDfs() {
+   size_t k = 0;
+   bool hasConst = false;
+   for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
+      if (!_dfsList[i]->inDfs()) continue;
+      if (_dfsList[i]->getType() == CONST_GATE) hasConst = true;
+      _dfsList[k++] = _dfsList[i];
+   }
+   _dfsList.resize(k);
+   if (!hasConst && _gateList[0]->inDfs())
+      _dfsList.insert(_dfsList.begin(), _gateList[0]);
+   freeRemoved();
+   _simEngine.invalidate();
+}
+// Gate "g" gains a reference from the DFS; bring it and its fanin cone
+// back if it had none
 void
-CirMgr::buildDfs(CirGate* g) {
-   if (g->isVisited()) return;
-   if (g->getType() == UNDEF_GATE) { // set true but don't push back to dfs list
-      g->setDfs(true);
-      return;
+CirMgr::acquireDfs(CirGate* g) {
+   if (g->inDfs()) return;
+   GateList stack(1, g);
+   g->setDfs(true);
+   while (!stack.empty()) {
+      unsigned id = stack.back()->getID();
+      stack.pop_back();
+      for (size_t i = 0, n = _aig.faninSize(id); i < n; ++i) {
+         CirGate* f = _gateList[_aig.lit(id, i) / 2];
+         if (_dfsRef[f->getID()]++ == 0 && !f->inDfs()) {
+            f->setDfs(true);
+            stack.push_back(f);
+         }
+      }
    }
-
-   for (size_t i = 0, n = g->_faninPtr.size(); i < n; ++i) {
-      buildDfs(g->_faninPtr[i]);
+}
+// Gate "g" has no reference from the DFS any more; drop it and every
+// fanin that it was the last reference of
+void
+CirMgr::releaseDfs(CirGate* g) {
+   if (!g->inDfs()) return;
+   GateList stack(1, g);
+   g->setDfs(false);
+   while (!stack.empty()) {
+      unsigned id = stack.back()->getID();
+      stack.pop_back();
+      for (size_t i = 0, n = _aig.faninSize(id); i < n; ++i) {
+         CirGate* f = _gateList[_aig.lit(id, i) / 2];
+         if (--_dfsRef[f->getID()] == 0 && f->inDfs()) {
+            f->setDfs(false);
+            stack.push_back(f);
+         }
+      }
    }
-   
-   _dfsList.push_back(g);
-
-   g->setDfs(true);
-   g->setMark(true);
 }
 
 
@@ -398,18 +591,15 @@ CirMgr::printFloatGates() const
    for (size_t i = 1, n = _gateList.size(); i < n; ++i) {
       if (_gateList[i]) {
          // float gate
-         if (_gateList[i]->_faninPtr.size() != 2 && _gateList[i]->getType() == AIG_GATE)
-            fl.push_back(_gateList[i]->getID());
-         
-         for (size_t j = 0, m = _gateList[i]->_faninPtr.size(); j < m; ++j) {
-            if (_gateList[i]->_faninPtr[j]->getType() == UNDEF_GATE) {
+         for (size_t j = 0, m = _aig.faninSize(i); j < m; ++j) {
+            if (_aig.type(_aig.lit(i, j) / 2) == UNDEF_GATE) {
                fl.push_back(_gateList[i]->getID());
                break;
             }
          }
 
          // not used gate
-         if (_gateList[i]->_fanoutPtr.size() == 0) {
+         if (_aig.fanoutSize(i) == 0) {
             if (_gateList[i]->getType() != CONST_GATE && _gateList[i]->getType() != PO_GATE) {
                notUsed.push_back(_gateList[i]->getID());
             }
@@ -435,13 +625,21 @@ CirMgr::printFloatGates() const
 void
 CirMgr::printFECPairs() const
 {
-   for (size_t i = 0, n = _fecGrps.size(); i < n; ++i) {
-      cout << '[' << i << ']';
-      for (size_t j = 0, m = _fecGrps[i]->size(); j < m; ++j) {
+   // groups are printed in the order of their heads (smallest IDs)
+   size_t cnt = 0;
+   for (size_t i = 0, n = _gateList.size(); i < n; ++i) {
+      CirGate* g = _gateList[i];
+      if (!g || !g->fecGrp()) continue;
+      size_t grp = g->fecGrp() - 1;
+      if (_fecGrps.head(grp) != g) continue;
+      cout << '[' << cnt++ << ']';
+      for (CirGate* const* it = _fecGrps.begin(grp),
+           * const* e = _fecGrps.end(grp); it != e; ++it) {
+         if (!*it) continue;
          cout << ' ';
-         if (_fecGrps[i]->at(j)->getSimValue() != _fecGrps[i]->at(0)->getSimValue())
+         if ((*it)->getSimValue() != g->getSimValue())
             cout << '!';
-         cout << _fecGrps[i]->at(j)->getID();
+         cout << (*it)->getID();
       }
       cout << endl;
    }
@@ -468,38 +666,85 @@ CirMgr::writeAag(ostream& outfile) const
 
    // PO
    for (size_t i = _header.m + 1, n = _gateList.size(); i < n; ++i) {
-      unsigned o = _gateList[i]->_fanin[0] * 2;
-      if (_gateList[i]->invert(0)) { ++o; }
-      outfile << o << endl;
+      outfile << _aig.lit(i, 0) << endl;
    }
 
    // AIG
    for (size_t i = 0; i < aig.size(); ++i) {
-      unsigned o[2];
-      for (int j = 0; j < 2; ++j) {
-         o[j] = aig[i]->_fanin[j] * 2;
-         if (aig[i]->invert(j)) { ++o[j]; }
-      }
-      outfile << aig[i]->getID() * 2 << " "
-            << o[0] << " " << o[1] << endl;
+      unsigned id = aig[i]->getID();
+      outfile << id * 2 << " "
+            << _aig.lit(id, 0) << " " << _aig.lit(id, 1) << endl;
    }
 
    // Symbol
-   for (size_t i = 0; i < _PIOrder.size(); ++i) {
-      int id = _PIOrder[i];
-      if (_gateList[id]->getSymbol().length() > 0) {
-         outfile << "i" << i << " " << _gateList[id]->getSymbol() << endl;
-      }
+   writeSymbol(outfile);
+
+   // Comment
+   outfile << "c" << endl;
+   outfile << "AAG output by Weiting Tang" << endl;
+}
+
+// Binary AIGER requires PIs to be 1..I and each AIG to have a larger
+// ID than its fanins, so the gates are renumbered: PIs in _PIOrder,
+// then AIGs in DFS order. Undefined gates become CONST0.
+void
+CirMgr::writeAig(ostream& outfile) const
+{
+   vector<CirGate*> aig;
+   resetFlag();
+   for (size_t i = _header.m + 1, n = _gateList.size(); i < n; ++i) {
+      dfsAIG(_gateList[i], aig);
    }
+   const unsigned ni = _PIOrder.size(), na = aig.size();
+   IdList var(_gateList.size(), 0);
+   for (unsigned i = 0; i < ni; ++i) var[_PIOrder[i]] = i + 1;
+   for (unsigned i = 0; i < na; ++i) var[aig[i]->getID()] = ni + i + 1;
+
+   // header
+   outfile << "aig " << ni + na << " " << ni << " " << _header.l << " "
+           << _header.o << " " << na << "\n";
+
+   // PO
    for (size_t i = _header.m + 1, n = _gateList.size(); i < n; ++i) {
-      if (_gateList[i]->getSymbol().length() > 0) {
-         outfile << "o" << i - (_header.m + 1) << " " << _gateList[i]->getSymbol() << endl;
-      }  
+      unsigned l = _aig.lit(i, 0);
+      outfile << var[l / 2] * 2 + (l & 1) << "\n";
    }
 
+   // AIG
+   for (unsigned i = 0; i < na; ++i) {
+      unsigned id = aig[i]->getID(), lhs = 2 * (ni + i + 1);
+      unsigned l0 = _aig.lit(id, 0), l1 = _aig.lit(id, 1);
+      unsigned rhs0 = var[l0 / 2] * 2 + (l0 & 1);
+      unsigned rhs1 = var[l1 / 2] * 2 + (l1 & 1);
+      if (rhs0 < rhs1) swap(rhs0, rhs1);
+      assert(lhs > rhs0);
+      writeDelta(outfile, lhs - rhs0);
+      writeDelta(outfile, rhs0 - rhs1);
+   }
+
+   // Symbol
+   writeSymbol(outfile);
+
    // Comment
    outfile << "c" << endl;
-   outfile << "AAG output by Weiting Tang" << endl;
+   outfile << "AIG output by Weiting Tang" << endl;
+}
+
+void
+CirMgr::writeSymbol(ostream& outfile) const
+{
+   for (size_t i = 0; i < _PIOrder.size(); ++i) {
+      const string& s = _aig.symbol(_PIOrder[i]);
+      if (s.length() > 0) {
+         outfile << "i" << i << " " << s << endl;
+      }
+   }
+   for (size_t i = _header.m + 1, n = _gateList.size(); i < n; ++i) {
+      const string& s = _aig.symbol(i);
+      if (s.length() > 0) {
+         outfile << "o" << i - (_header.m + 1) << " " << s << endl;
+      }  
+   }
 }
 
 void
@@ -539,21 +784,16 @@ CirMgr::writeGate(ostream& outfile, CirGate *g) const
 
    // AIG
    for (size_t i = 0; i < aig.size(); ++i) {
-      unsigned o[2];
-      for (int j = 0; j < 2; ++j) {
-         o[j] = _gateList[aig[i]]->_fanin[j] * 2;
-         if (_gateList[aig[i]]->invert(j)) { ++o[j]; }
-      }
-      outfile << _gateList[aig[i]]->getID() * 2 << " "
-            << o[0] << " " << o[1] << endl;
+      outfile << aig[i] * 2 << " "
+            << _aig.lit(aig[i], 0) << " " << _aig.lit(aig[i], 1) << endl;
    }
 
    // Symbol
    for (size_t i = 0, n = _PIOrder.size(); i < n; ++i) {
       for (size_t j = 0, m = pi.size(); j < m; ++j) {
          if (_PIOrder[i] == pi[j]){
-            if (_gateList[_PIOrder[i]]->getSymbol().length() > 0) {
-               outfile << "i" << i << " " << _gateList[_PIOrder[i]]->getSymbol() << endl;
+            if (_aig.symbol(_PIOrder[i]).length() > 0) {
+               outfile << "i" << i << " " << _aig.symbol(_PIOrder[i]) << endl;
             }
          }
       }
@@ -565,28 +805,39 @@ CirMgr::writeGate(ostream& outfile, CirGate *g) const
    outfile << "Write gate(" << g->getID() << ") by Weiting Tang" << endl;
 }
 
+// The AIGs of dfs(g)
 void
 CirMgr::dfsAIG(CirGate* g, GateList& a) const {
-   if (g->isVisited() || g->getType() == UNDEF_GATE) return;
-   for (size_t i = 0; i < g->_faninPtr.size(); ++i) {
-      dfsAIG(g->_faninPtr[i], a);
+   size_t k = a.size();
+   dfs(g, a);
+   for (size_t i = k, n = a.size(); i < n; ++i) {
+      if (a[i]->getType() == AIG_GATE) a[k++] = a[i];
    }
-   
-   if (g->getType() == AIG_GATE) {
-      a.push_back(g);
-   }
-
-   g->setMark(true);
+   a.resize(k);
 }
 
+// Post-order DFS from "g" over the unmarked, defined gates, visiting the
+// fanins from left to right. An explicit stack replaces the recursion
+// so that deep circuits cannot overflow the call stack.
 void
 CirMgr::dfs(CirGate* g, GateList& a) const {
    if (g->isVisited() || g->getType() == UNDEF_GATE) return;
-   for (size_t i = 0; i < g->_faninPtr.size(); ++i) {
-      dfs(g->_faninPtr[i], a);
-   }
-   
-   a.push_back(g);
-
+   vector<pair<CirGate*, unsigned> > stack;
+   stack.push_back(make_pair(g, 0u));
    g->setMark(true);
-}
\ No newline at end of file
+   while (!stack.empty()) {
+      CirGate* x = stack.back().first;
+      unsigned i = stack.back().second;
+      if (i < _aig.faninSize(x->getID())) {
+         ++stack.back().second;
+         CirGate* f = _gateList[_aig.lit(x->getID(), i) / 2];
+         if (f->isVisited() || f->getType() == UNDEF_GATE) continue;
+         f->setMark(true);
+         stack.push_back(make_pair(f, 0u));
+      }
+      else {
+         a.push_back(x);
+         stack.pop_back();
+      }
+   }
+}
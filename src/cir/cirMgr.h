@@ -19,21 +19,21 @@ using namespace std;
 // TODO: Feel free to define your own classes, variables, or functions.
 
 #include "cirDef.h"
+#include "cirAig.h"
 #include "cirGate.h"
+#include "cirSimEngine.h"
+#include "cirFec.h"
+#include "cirProver.h"
+#include "cirStrash.h"
 
 extern CirMgr *cirMgr;
 
 class CirMgr
 {
 public:
-   CirMgr() {}
-   ~CirMgr() {
-      for (size_t i = 0, n = _gateList.size(); i < n; ++i) {
-         if (_gateList[i]) {
-            delete _gateList[i];
-         }
-      }
-   } 
+   CirMgr(): _strashOnRead(false) {}
+   // the gates are released with _gatePool
+   ~CirMgr() {}
 
    // Access functions
    // return '0' if "gid" corresponds to an undefined gate.
@@ -41,9 +41,12 @@ public:
       if (gid >= _gateList.size()) return 0;
       return _gateList[gid];
    }
+   const CirAig& getAig() const { return _aig; }
 
    // Member functions about circuit construction
-   bool readCircuit(const string&);
+   // with "strash", each AIG is simplified (as by optimize()) and strashed
+   // as it is read, so that only the canonical ones are constructed
+   bool readCircuit(const string&, bool strash = false);
 
    // Member functions about circuit optimization
    void sweep();
@@ -54,12 +57,17 @@ public:
    void randomSim();
    void fileSim(ifstream&);
    void setSimLog(ofstream *logFile) { _simLog = logFile; }
+   bool setSimKernel(SimKernel k) { return _simEngine.setKernel(k); }
+   // also used by the resimulation in fraig()
+   void setSimThreads(size_t n) { _simEngine.setThreads(n); }
 
    // Member functions about fraig
    void strash();
    void printFEC() const;
-   void fraig();
-   HashKey getKey(CirGate* g) const;
+   // more than one thread proves the FEC groups in parallel; "justify"
+   // makes the SAT solver work on the circuit (see CirProver)
+   void fraig(size_t threads = 1, bool justify = false);
+   const CirFecGrps& getFecGrps() const { return _fecGrps; }
 
    // Member functions about circuit reporting
    void printSummary() const;
@@ -69,6 +77,7 @@ public:
    void printFloatGates() const;
    void printFECPairs() const;
    void writeAag(ostream&) const;
+   void writeAig(ostream&) const;
    void writeGate(ostream&, CirGate*) const;
    void dfsAIG(CirGate*, vector<CirGate*>&) const;
    void dfs(CirGate*, vector<CirGate*>&) const;
@@ -92,9 +101,19 @@ public:
 
 private:
    ofstream           *_simLog;
-   GateList           _gateList;
+   CirAig             _aig;       // structure of the netlist
+   CirGatePool        _gatePool;  // storage of the gates
+   GateList           _gateList;  // gate views of _aig
    GateList           _dfsList;
-   vector<GateList*>  _fecGrps;
+   IdList             _dfsRef;    // #references from _dfsList
+   GateList           _removed;   // by change(), may be in _dfsList
+   CirFecGrps         _fecGrps;
+   CirSimEngine       _simEngine;
+   bool               _strashOnRead;
+   CirStrashTable     _strash;    // of the AIGs read so far
+   IdList             _waitHead;  // first AIG waiting for each gate
+   IdList             _waitNext;  // next AIG in the same list
+   IdList             _readStack;
 
    struct Header {
       string aag;
@@ -106,26 +125,47 @@ private:
    };
 
    Header _header;
-   void readHeader(const string& x);
-   void readPI(const string& x, const unsigned& line);
-   void readPO(const string& x, const unsigned& line, const unsigned& No);
-   void readAIG(const string& x, const unsigned& line);
-   void readSymbol(const string& x);
-   void readComment(const string& x);
+   bool readAiger(const char* p, const char* end);
+   bool readHeader(const char*& p, const char* end);
+   void readPI(unsigned lit, unsigned line);
+   void readPO(unsigned lit, unsigned line, unsigned No);
+   void readAIG(unsigned lhs, unsigned rhs0, unsigned rhs1, unsigned line);
+   void strashAIGs();
+   void flushAIGs();
+   bool foldAIG(unsigned id);
+   static bool simplifyAnd(unsigned l0, unsigned l1, unsigned& l);
+   void simplifyFanouts(IdList& ids);
+   void readSymbol(const char*& p, const char* end);
+   void readComment(const char* p, const char* end);
+   void writeSymbol(ostream&) const;
    void buildConnection();
    void buildDfs();
-   void buildDfs(CirGate* g);
-   void dfsTravel(CirGate* g, int& index) const;
+   void updateDfs();
+   void acquireDfs(CirGate* g);
+   void releaseDfs(CirGate* g);
+   void freeRemoved() {
+      for (size_t i = 0, n = _removed.size(); i < n; ++i)
+         _gatePool.free(_removed[i]);
+      _removed.clear();
+   }
    
-   size_t simulate(bool p = false);
+   void initSim(size_t words);
+   size_t simulate(size_t words = 1, bool p = false, SimType t = ALL_GATE);
+   size_t simWords() const;
+   void loadSimValues(size_t words);
    unsigned maxFail(size_t);
    bool initFecGrps();
-   void writeLog(size_t size = SIZE_T);
-   void setFecGrp();
-
-   void setVar(SatSolver&);
-   void constProofModel(SatSolver&);
-   bool proveSat(CirGate *, CirGate *, SatSolver&, const bool&);
+   void writeLog(size_t patterns = SIZE_T);
+
+   void parFraig(size_t threads, bool justify);
+   size_t fraigConst(const vector<CirProver*>&, vector<size_t>&);
+   size_t parFraigConst(CirThreadPool&, const vector<CirProver*>&,
+                        vector<vector<size_t> >&);
+   void mergeConst(const GateList&);
+   void simCex(CirProver&, CirGate*, CirGate*, vector<size_t>&);
+   void resimCex(vector<vector<size_t> >&);
+   int proveSat(CirGate *, CirGate *, CirProver&, const bool&,
+                long long conf = FRAIG_CONF_BUDGET);
    void resetFecGrps();
 
    vector<unsigned> _PIOrder;
@@ -50,55 +50,21 @@ CirMgr::sweep()
 // Recursively simplifying from POs;
 // _dfsList needs to be reconstructed afterwards
 // UNDEF gates may be delete if its fanout becomes empty...
+// A merged gate leaves its FEC group
 void
 CirMgr::optimize()
 {
-   bool inv;
-   int cnt, other;
-   unsigned id;
-   CirGate* replace = 0;
+   unsigned l;
    for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
       if (_dfsList[i]->getType() != AIG_GATE) continue;
 
-      id = _dfsList[i]->getID();
-      cnt = 0;
-      inv = false;
-      replace = 0;
-      while (!replace && cnt < 2) {
-         if (_dfsList[i]->_faninPtr[cnt]->getType() == CONST_GATE) {
-            // const 1
-            other = cnt == 0? 1: 0;
-            if (_dfsList[i]->invert(cnt)) {
-               // replace with another fanin
-               replace = _dfsList[i]->_faninPtr[other];
-               inv = _dfsList[i]->invert(other);
-            }
-            // const 0
-            else {
-               replace = _gateList[0];
-            }
-            break;
-         }
-         ++cnt;
-      }
-      if (!replace && _dfsList[i]->_faninPtr[0] == _dfsList[i]->_faninPtr[1]) {
-         // identical
-         if (_dfsList[i]->invert(0) == _dfsList[i]->invert(1)) {
-            // replace with any one of fanins
-            replace = _dfsList[i]->_faninPtr[0];
-            inv = _dfsList[i]->invert(0);
-         }
-         // invert
-         else {
-            // replace with const 0
-            replace = _gateList[0];
-         }
-      }
-      if (replace) {
-         cout << "Simplifying: " << replace->getID() << " merging ";
-         if (inv) cout << "!";
+      const unsigned id = _dfsList[i]->getID();
+      if (simplifyAnd(_aig.lit(id, 0), _aig.lit(id, 1), l)) {
+         cout << "Simplifying: " << l / 2 << " merging ";
+         if (l & 1) cout << "!";
          cout << id << "..." << endl;
-         change(_gateList[id], replace, inv);
+         _fecGrps.remove(_gateList[id]);
+         change(_gateList[id], _gateList[l / 2], l & 1);
       }
    }
    buildDfs(); // update dfs list
@@ -107,40 +73,65 @@ CirMgr::optimize()
 /***************************************************/
 /*   Private member functions about optimization   */
 /***************************************************/
+// optimize() restricted to the gates in "ids", whose fanins have just
+// been merged, and to the fanouts of each gate it simplifies in turn;
+// "ids" is used as the work list. Only gates in the DFS are simplified,
+// and _dfsList is to be patched by updateDfs() afterwards.
 void
-CirMgr::change(CirGate*& del, CirGate* replace, bool inv)
+CirMgr::simplifyFanouts(IdList& ids)
 {
-   // clearing del's fanins' fanouts
-   for (size_t i = 0, n = del->_faninPtr.size(); i < n; ++i) {
-      CirGate* t = del->_faninPtr[i];
-      int index = del->findFanoutIndex(t);
-      t->_fanoutPtr.erase(t->_fanoutPtr.begin() + index);
-      t->_fanout.erase(t->_fanout.begin() + index);
-   }
-   // adding replace's fanouts
-   if (replace) {
-      for (size_t i = 0, n = del->_fanoutPtr.size(); i < n; ++i) {
-         replace->_fanout.push_back(del->_fanoutPtr[i]->getID());
-         replace->_fanoutPtr.push_back(del->_fanoutPtr[i]);
-      }
+   unsigned l;
+   while (!ids.empty()) {
+      const unsigned id = ids.back();
+      ids.pop_back();
+      CirGate* g = _gateList[id];
+      if (!g || g->getType() != AIG_GATE || !g->inDfs()) continue;
+      if (!simplifyAnd(_aig.lit(id, 0), _aig.lit(id, 1), l)) continue;
+
+      cout << "Simplifying: " << l / 2 << " merging ";
+      if (l & 1) cout << "!";
+      cout << id << "..." << endl;
+      for (unsigned s = _aig.firstFanout(id); s != CirAig::NO_FANOUT;
+           s = _aig.nextFanout(id, s))
+         ids.push_back(s / 2);
+      _fecGrps.remove(g);
+      change(_gateList[id], _gateList[l / 2], l & 1);
    }
-   // maintain del's fanouts' fanins
-   for (size_t i = 0, n = del->_fanoutPtr.size(); i < n; ++i) {
-      CirGate* t = del->_fanoutPtr[i];
-      int index = del->findFaninIndex(t);
-      if (replace) {
-         t->_fanin[index] = replace->getID();
-         t->_faninPtr[index] = replace;
-         if (inv) t->inverseInvert(index);
-      }
-      else {
-         t->_faninPtr.erase(t->_faninPtr.begin() + index);
-         t->_fanin.erase(t->_fanin.begin() + index);
-         t->deleteInvert(index);
+}
+
+// If the AND of literals l0 and l1 is trivially a literal, set l to it:
+// a constant fanin gives the other fanin or const 0 (checked in fanin
+// order), identical fanins give the fanin and complementary ones const 0.
+bool
+CirMgr::simplifyAnd(unsigned l0, unsigned l1, unsigned& l)
+{
+   if (l0 / 2 == 0) l = l0 & 1? l1: 0;
+   else if (l1 / 2 == 0) l = l1 & 1? l0: 0;
+   else if (l0 / 2 == l1 / 2) l = l0 == l1? l0: 0;
+   else return false;
+   return true;
+}
+
+// The fanouts of "del" are not rewired here: _aig forwards every
+// reference to "del" to the replacing literal. The DFS flags follow the
+// merge (see updateDfs()). "del" may still be in _dfsList, so it is freed
+// by the next buildDfs() or updateDfs(), which read its DFS flag.
+void
+CirMgr::change(CirGate*& del, CirGate* replace, bool inv)
+{
+   const unsigned id = del->getID();
+   if (del->inDfs()) {
+      if (replace && _dfsRef[id]) {
+         _dfsRef[replace->getID()] += _dfsRef[id];
+         acquireDfs(replace);
       }
+      releaseDfs(del);
    }
+   _dfsRef[id] = 0;
+   if (replace) _aig.merge(del->getID(), replace->getID() * 2 + inv);
+   else _aig.remove(del->getID());
 
    if (del->getType() == AIG_GATE) --_header.a;
-   delete del;
+   _removed.push_back(del);
    del = 0;
 }
\ No newline at end of file
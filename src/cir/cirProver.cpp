@@ -0,0 +1,247 @@
+/****************************************************************************
+  FileName     [ cirProver.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the SAT prover of fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include "cirProver.h"
+
+using namespace std;
+
+static const unsigned NO_FANIN = ~0u;
+// activity a gate starts with per level, to rank the fresh variables;
+// any conflict outweighs it
+static const double LEVEL_ACTIVITY = 1e-6;
+// most inputs of the CNF of a tree of ANDs (see CirProver::cut())
+static const size_t CNF_MAX_INPUTS = 16;
+
+/****************************************/
+/*   class CirProver member functions   */
+/****************************************/
+void
+CirProver::init()
+{
+   _solver.initialize();
+   _solver.setJustify(_justify);
+   _var.assign(_aig.size(), var_Undef);
+   _fanin.assign(_aig.size() * 2, NO_FANIN);
+   _level.assign(_aig.size(), 0);
+   _mark.assign(_aig.size(), 0);
+   _stamp = 0;
+   _rot = 0;
+}
+
+// Give v and its transitive fanins a solver variable, adding the CNF of
+// the gates that did not have one yet; the gates absorbed by the CNF of
+// another (see cut()) are skipped
+void
+CirProver::loadCone(unsigned v)
+{
+   if (_var[v] != var_Undef) return;
+   _stack.assign(1, v);
+   while (!_stack.empty()) {
+      const unsigned x = _stack.back();
+      if (_var[x] != var_Undef) { _stack.pop_back(); continue; }
+      CnfKind k = CNF_AND;
+      if (_aig.type(x) == AIG_GATE) k = cut(x);
+      else _cut.clear();
+      bool ready = true;
+      for (size_t i = 0, n = _cut.size(); i < n; ++i) {
+         const unsigned f = _cut[i] / 2;
+         if (_var[f] == var_Undef) { _stack.push_back(f); ready = false; }
+      }
+      if (!ready) continue;
+      _stack.pop_back();
+      _var[x] = _solver.newVar(false);
+      if (_aig.type(x) == AIG_GATE) {
+         const unsigned* c = &_cut[0];
+         if (k == CNF_XOR)
+            _solver.addXorCNF(_var[x], _var[c[0] / 2], c[0] & 1,
+                              _var[c[1] / 2], c[1] & 1);
+         else if (k == CNF_MUX)
+            _solver.addMuxCNF(_var[x], _var[c[0] / 2], c[0] & 1,
+                              _var[c[1] / 2], c[1] & 1,
+                              _var[c[2] / 2], c[2] & 1);
+         else if (_cut.size() == 2)
+            _solver.addAigCNF(_var[x], _var[c[0] / 2], c[0] & 1,
+                              _var[c[1] / 2], c[1] & 1);
+         else {
+            vec<Lit> ins;
+            for (size_t i = 0, n = _cut.size(); i < n; ++i)
+               ins.push(Lit(_var[c[i] / 2], c[i] & 1));
+            _solver.addAndCNF(_var[x], ins);
+         }
+         // the cones stay those of the netlist, through the absorbed gates
+         _inner.push_back(x);
+         for (size_t i = 0, n = _inner.size(); i < n; ++i) {
+            const unsigned g = _inner[i];
+            _fanin[g * 2] = _aig.lit(g, 0) / 2;
+            _fanin[g * 2 + 1] = _aig.lit(g, 1) / 2;
+         }
+         unsigned l = 0;
+         for (size_t i = 0, n = _cut.size(); i < n; ++i)
+            if (_level[c[i] / 2] > l) l = _level[c[i] / 2];
+         _level[x] = l + 1;
+         if (_justify)
+            _solver.seedActivity(_var[x], _level[x] * LEVEL_ACTIVITY);
+      }
+      else if (_aig.type(x) == CONST_GATE)
+         _solver.assertProperty(_var[x], false);
+   }
+}
+
+int
+CirProver::prove(unsigned a, unsigned b, bool inv, long long conf)
+{
+   int isSat;
+   loadCone(a);
+   loadCone(b);
+   markCones(a, b);
+   setDecisionVars(a, b, true);
+   if (_aig.type(b) == CONST_GATE) { // if b is const 0, just prove a
+      _solver.assumeRelease();
+      _solver.assumeProperty(_var[a], !inv);
+      isSat = _solver.assumpSolve(conf, FRAIG_PROP_BUDGET);
+   }
+   else {
+      // a guarded miter, retired right after the proof; its variable is
+      // reused once simplifyDB() has dropped the clauses (releaseVar())
+      Var act = _solver.newVar(false);
+      _solver.addMiterCNF(act, _var[a], _var[b], inv);
+      _solver.assumeRelease();
+      _solver.assumeProperty(act, true);
+      isSat = _solver.assumpSolve(conf, FRAIG_PROP_BUDGET);
+      _solver.releaseVar(act, false);
+   }
+   setDecisionVars(a, b, false);
+   return isSat;
+}
+
+void
+CirProver::addEq(unsigned a, unsigned b, bool inv)
+{
+   if (_var[a] == var_Undef || _var[b] == var_Undef) return;
+   _solver.addEqCNF(_var[a], _var[b], inv);
+}
+
+void
+CirProver::expand(unsigned a, unsigned b, const IdList& pis, size_t* words)
+{
+   assert(_mark[a] == _stamp && _mark[b] == _stamp);
+   size_t n = 0;
+   for (size_t k = 0, l = pis.size(); k < l; ++k)
+      if (_mark[pis[k]] == _stamp) ++n;
+   for (size_t k = 0, l = pis.size(), s = 0; k < l; ++k) {
+      words[k] = value(pis[k])? ~size_t(0): 0;
+      if (_mark[pis[k]] != _stamp) continue;
+      // the (_rot + j - 1)-th support PI goes to bit j
+      const size_t j = (s++ + n - _rot % n) % n + 1;
+      if (j < SIZE_T) words[k] ^= size_t(1) << j;
+   }
+   _rot += SIZE_T - 1;
+}
+
+// x = !(s & t') & !(!s & e'), with both ANDs going nowhere else, is a MUX
+// x = s? !t': !e'; m gets (s, !t', !e') as literals. It is an XOR
+// x = s ^ !e' instead if t' == !e'; m gets (s, !e').
+CirProver::CnfKind
+CirProver::findMux(unsigned x, unsigned* m) const
+{
+   const unsigned l0 = _aig.lit(x, 0), l1 = _aig.lit(x, 1);
+   if (!(l0 & l1 & 1) || l0 == l1) return CNF_AND;
+   const unsigned y = l0 / 2, z = l1 / 2;
+   if (!absorbable(y) || !absorbable(z)) return CNF_AND;
+   for (unsigned i = 0; i < 2; ++i)
+      for (unsigned j = 0; j < 2; ++j) {
+         const unsigned s = _aig.lit(y, i);
+         if (s != (_aig.lit(z, j) ^ 1)) continue;
+         const unsigned t = _aig.lit(y, 1 - i) ^ 1;
+         const unsigned e = _aig.lit(z, 1 - j) ^ 1;
+         m[0] = s;
+         if (t == (e ^ 1)) { m[1] = e; return CNF_XOR; }
+         m[1] = t;
+         m[2] = e;
+         return CNF_MUX;
+      }
+   return CNF_AND;
+}
+
+// The inputs of the CNF of AND gate x into _cut and the gates it absorbs
+// into _inner: the three inputs of a MUX, the two of an XOR, or else the
+// leaves of the tree of ANDs under x that have no other fanout (at most
+// CNF_MAX_INPUTS). With justification every gate keeps its 2-input CNF,
+// which is what the solver justifies.
+CirProver::CnfKind
+CirProver::cut(unsigned x)
+{
+   unsigned m[3];
+   _cut.clear();
+   _inner.clear();
+   if (!_justify) {
+      const CnfKind k = findMux(x, m);
+      if (k != CNF_AND) {
+         _inner.push_back(_aig.lit(x, 0) / 2);
+         _inner.push_back(_aig.lit(x, 1) / 2);
+         _cut.assign(m, m + (k == CNF_XOR? 2: 3));
+         return k;
+      }
+   }
+   _cut.push_back(_aig.lit(x, 0));
+   _cut.push_back(_aig.lit(x, 1));
+   if (_justify) return CNF_AND;
+   for (size_t i = 0; i < _cut.size() && _cut.size() < CNF_MAX_INPUTS; ) {
+      const unsigned l = _cut[i], g = l / 2;
+      if ((l & 1) || !absorbable(g) || findMux(g, m) != CNF_AND) {
+         ++i;
+         continue;
+      }
+      _inner.push_back(g);
+      _cut[i] = _aig.lit(g, 0);
+      _cut.push_back(_aig.lit(g, 1));
+   }
+   return CNF_AND;
+}
+
+// Turn the decisions of a proof of (a, b) on or off. Without justification
+// the solver may decide on any gate in _cone; with it, only on a, b and the
+// inputs of _cone, and the gates in between are justified from their
+// fanins (see SatSolver::setJustify())
+void
+CirProver::setDecisionVars(unsigned a, unsigned b, bool d)
+{
+   for (size_t i = 0, n = _cone.size(); i < n; ++i) {
+      const unsigned x = _cone[i];
+      if (_var[x] == var_Undef) continue; // absorbed
+      if (!_justify || _fanin[x * 2] == NO_FANIN)
+         _solver.setDecisionVar(_var[x], d);
+      else
+         _solver.setJustifyGate(_var[x], d);
+   }
+   if (_justify) {
+      _solver.setDecisionVar(_var[a], d);
+      _solver.setDecisionVar(_var[b], d);
+   }
+}
+
+// Collect the gates in the encoded fanin cones of a and b into _cone
+void
+CirProver::markCones(unsigned a, unsigned b)
+{
+   if (!++_stamp) { fill(_mark.begin(), _mark.end(), 0); _stamp = 1; }
+   _cone.clear();
+   _cone.push_back(a);
+   _mark[a] = _stamp;
+   if (_mark[b] != _stamp) { _cone.push_back(b); _mark[b] = _stamp; }
+   for (size_t k = 0; k < _cone.size(); ++k) {
+      for (unsigned i = _cone[k] * 2, e = i + 2; i < e; ++i) {
+         const unsigned f = _fanin[i];
+         if (f == NO_FANIN || _mark[f] == _stamp) continue;
+         _mark[f] = _stamp;
+         _cone.push_back(f);
+      }
+   }
+}
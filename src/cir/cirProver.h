@@ -0,0 +1,99 @@
+/****************************************************************************
+  FileName     [ cirProver.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the SAT prover of fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_PROVER_H
+#define CIR_PROVER_H
+
+#include <vector>
+#include "cirDef.h"
+#include "cirAig.h"
+#include "sat.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   class CirProver
+//------------------------------------------------------------------------
+// A SAT solver over the cones of a CirAig. A variable gets its solver
+// variable and CNF the first time a proof needs it (loadCone()), and the
+// clauses, including the learnt ones, are kept until the next init().
+// The variables are not decision variables by default: a proof turns on
+// only those in the cones of its two gates, so the solver never branches
+// on the rest of the loaded logic, which is left to propagation. The
+// cones are taken as encoded (_fanin), not as in the netlist, which may
+// have been merged since.
+// The CNF is kept small: a gate whose only fanout is an AND gate goes
+// into the CNF of that gate, so a tree of such ANDs is one multi-input AND
+// and the two ANDs under a MUX or an XOR are a MUX or XOR of their inputs.
+// The gates so absorbed get no variable until a proof needs one of them.
+// With "justify", the solver works on the circuit instead: it decides on
+// the two gates and the inputs of their cones only, and the gates in
+// between that are 0 are justified by setting one of their fanins to 0.
+// The fresh variables are then ranked by their topological level, so the
+// search starts from the top of the cones.
+// The prover only reads the netlist, so provers on different threads may
+// share one CirAig as long as no forwarding literal is left in the cones
+// they load (see CirAig::lit()) and nobody changes the netlist meanwhile.
+class CirProver
+{
+public:
+   CirProver(const CirAig& aig, bool justify = false):
+      _aig(aig), _justify(justify), _stamp(0), _rot(0) {}
+   ~CirProver() {}
+
+   void init();
+
+   Var var(unsigned v) const { return _var[v]; }
+   void loadCone(unsigned v);
+   // 1 if a != b (or a != !b if inv), 0 if they are proven equal and -1
+   // if the query runs out of its budget ("conf" conflicts and
+   // FRAIG_PROP_BUDGET); b may be the constant gate
+   int prove(unsigned a, unsigned b, bool inv,
+             long long conf = FRAIG_CONF_BUDGET);
+   // a == b (or a == !b if inv) after a merge; no-op unless both are
+   // loaded, since the clauses of a loaded cone stay valid anyway
+   void addEq(unsigned a, unsigned b, bool inv);
+   // value of v in the model of the last SAT proof; 0 if v is not loaded
+   bool value(unsigned v) const {
+      return _var[v] != var_Undef && _solver.getValue(_var[v]) == 1;
+   }
+   // one word per PI of "pis" right after a SAT proof of (a, b): bit 0 is the
+   // model and bit j (j > 0) flips one PI in the support of a and b; the
+   // PIs are taken in turn, so a support wider than 63 PIs is covered by
+   // the following calls
+   void expand(unsigned a, unsigned b, const IdList& pis, size_t* words);
+
+private:
+   const CirAig&     _aig;
+   bool              _justify;
+   SatSolver         _solver;
+   vector<Var>       _var;     // solver variable of each gate
+   vector<unsigned>  _fanin;   // fanin gates in the CNF, 2 per gate
+   vector<unsigned>  _level;   // topological level in the CNF
+   vector<unsigned>  _stack;   // scratch buffer of loadCone()
+   vector<unsigned>  _cut;     // inputs of the CNF of a gate, as literals
+   vector<unsigned>  _inner;   // gates absorbed by it
+   vector<unsigned>  _cone;    // cones of the last proof
+   vector<unsigned>  _mark;    // == _stamp if in _cone
+   unsigned          _stamp;
+   size_t            _rot;     // first support PI flipped by expand()
+
+   // the CNF of an AND gate (see cut())
+   enum CnfKind { CNF_AND, CNF_XOR, CNF_MUX };
+
+   bool absorbable(unsigned v) const {
+      return _aig.type(v) == AIG_GATE && _var[v] == var_Undef &&
+             _aig.singleFanout(v);
+   }
+   CnfKind findMux(unsigned x, unsigned* m) const;
+   CnfKind cut(unsigned x);
+   void markCones(unsigned a, unsigned b);
+   void setDecisionVars(unsigned a, unsigned b, bool d);
+};
+
+#endif // CIR_PROVER_H
@@ -28,7 +28,6 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
-
 /************************************************/
 /*   Public member functions about Simulation   */
 /************************************************/
@@ -40,27 +39,29 @@ CirMgr::randomSim()
    unsigned fail = 0;
    unsigned maxF = maxFail(_dfsList.size());
    size_t pre = 0, cur = 0;
+   const size_t w = simWords();
+   initSim(w);
    while (fail < maxF) {
-      size_t r = 0;
       for (size_t i = 0, n = _PIOrder.size(); i < n; ++i) {
-         r = ran(INT_MAX);
-         // 64 bits device
-         if (SIZE_T == 64) {
-            r <<= 32;
-            r += ran(INT_MAX);
+         size_t* row = _simEngine[_PIOrder[i]];
+         for (size_t k = 0; k < w; ++k) {
+            size_t r = ran(INT_MAX);
+            // 64 bits device
+            if (SIZE_T == 64) {
+               r <<= 32;
+               r += ran(INT_MAX);
+            }
+            row[k] = r;
          }
-         _gateList[_PIOrder[i]]->setSimValue(r);
       }
-      cur = simulate(true);
+      cur = simulate(w, true);
       if (cur == pre) ++fail;
       else fail = 0;
       pre = cur;
-      writeLog();
-      num += 64;
+      writeLog(w * SIZE_T);
+      num += w * SIZE_T;
       if (cur == 0) break;
    }
-   sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-   setFecGrp();
    cout << char(13) << "                                        " << char(13) << num 
          << " patterns simulated." << endl;
 }
@@ -69,109 +70,112 @@ void
 CirMgr::fileSim(ifstream& patternFile)
 {
    int cnt = 0;
-   vector<size_t> pattern(_header.i, 0);
+   const size_t w = simWords();
+   const size_t batch = w * SIZE_T;
+   initSim(w);
+   for (size_t i = 0, n = _PIOrder.size(); i < n; ++i)
+      fill(_simEngine[_PIOrder[i]], _simEngine[_PIOrder[i]] + w, 0);
    string input;
    while (patternFile >> input) {
-      if (input.size() != _header.i) {
+      bool legal = input.size() == _header.i;
+      if (!legal) {
          cerr << "\nError: Pattern(" << input << ") length(" << input.size() 
          << ") does not match the number of inputs(" << _header.i << ") in a circuit!!" << endl;
-         sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-         setFecGrp();
-         cout << char(13) << SIZE_T * (cnt / SIZE_T) << " patterns simulated." << endl;
-         return;
       }
-      for (size_t i = 0, n = input.size(); i < n; ++i) {
-         if (input[i] == '1') pattern[i] += ((size_t)1 << (cnt % SIZE_T));
+      for (size_t i = 0, n = input.size(); legal && i < n; ++i) {
+         size_t& word = _simEngine[_PIOrder[i]][cnt % batch / SIZE_T];
+         if (input[i] == '1') word += ((size_t)1 << (cnt % SIZE_T));
          else if (input[i] != '0') { // illegal input
             cerr << "\nError: Pattern(" << input << ") contains a non-0/1 character(\'" << input[i] << "\')." << endl;
-            sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-            setFecGrp();
-            cout << char(13) << SIZE_T * (cnt / SIZE_T) << " patterns simulated." << endl;
-            return;
+            legal = false;
          }
       }
-      if (!(++cnt % SIZE_T)) {
-         for (size_t i = 0, n = _PIOrder.size(); i < n; ++i) {
-            _gateList[_PIOrder[i]]->setSimValue(pattern[i]);
-            pattern[i] = 0;
+      if (!legal) {
+         // only the complete words of the current batch are simulated
+         size_t words = cnt % batch / SIZE_T;
+         if (words) {
+            simulate(words, true);
+            writeLog(words * SIZE_T);
          }
-         simulate(true);
-         writeLog();
+         cout << char(13) << SIZE_T * (cnt / SIZE_T) << " patterns simulated." << endl;
+         return;
       }
-   }
-   if (cnt % SIZE_T) {
-      for (size_t i = 0, n = _PIOrder.size(); i < n; ++i) {
-         _gateList[_PIOrder[i]]->setSimValue(pattern[i]);
+      if (!(++cnt % batch)) {
+         simulate(w, true);
+         writeLog(batch);
+         for (size_t i = 0, n = _PIOrder.size(); i < n; ++i)
+            fill(_simEngine[_PIOrder[i]], _simEngine[_PIOrder[i]] + w, 0);
       }
-      simulate(true);
-      writeLog(cnt % SIZE_T);
    }
-   sort(_fecGrps.begin(), _fecGrps.end(), [](GateList* a, GateList* b) { return a->at(0)->getID() < b->at(0)->getID(); });
-   setFecGrp();
+   if (cnt % batch) {
+      simulate((cnt % batch + SIZE_T - 1) / SIZE_T, true);
+      writeLog(cnt % batch);
+   }
    cout << char(13) << cnt << " patterns simulated." << endl;
 }
 
 /*************************************************/
 /*   Private member functions about Simulation   */
 /*************************************************/
-
+// Simulate the first "words" words of every PI row in _simEngine and
+// refine the FEC groups with the resulting signatures.
+// EVENT_DRIVEN only propagates the PI words written by setInput(), and if
+// the last simulation had as many words, only the gates it changes are
+// reloaded and only their groups are refined.
 size_t
-CirMgr::simulate(bool p)
+CirMgr::simulate(size_t words, bool p, SimType t)
 {
-   // all gate
-   initFecGrps();
-   for (size_t i = 0, n = _dfsList.size(); i < n; ++i)
-      _dfsList[i]->simulate(ALL_GATE);
-   // event driven
-   /*
-   else {
-      resetFlag();
-      for (size_t i = 0, n = _dfsList.size(); i < n; ++i)
-         if (_dfsList[i]->getType() == PO_GATE)
-            _dfsList[i]->simulate(EVENT_DRIVEN);
-   }*/
-
-   vector<GateList*> tmpList;
-   for (size_t i = 0, n = _fecGrps.size(); i < n; ++i) {
-      HashMap<HashKey, GateList*> newFecGrps(getHashSize(_fecGrps[i]->size()));
-      for (size_t j = 0, m = _fecGrps[i]->size(); j < m; ++j) {
-         HashKey key(_fecGrps[i]->at(j)->getSimValue());
-         GateList *grp;
-         if (newFecGrps.check(key, grp)) {
-            grp->push_back(_fecGrps[i]->at(j));
-         }
-         else {
-            grp = new GateList();
-            grp->push_back(_fecGrps[i]->at(j));
-            newFecGrps.forceInsert(key, grp);
-            tmpList.push_back(grp);
-         }
+   if (!_simEngine.isCompiled())
+      _simEngine.compile(_dfsList, _aig);
+   assert(words > 0 && words <= _simEngine.words());
+   const bool init = initFecGrps();
+   if (_simEngine.simulate(words, t) && !init) {
+      const vector<unsigned>& rows = _simEngine.changed();
+      vector<unsigned> grps;
+      for (size_t i = 0, n = rows.size(); i < n; ++i) {
+         CirGate* g = _gateList[rows[i]];
+         g->setSimValue(_simEngine[rows[i]][words - 1]);
+         if (g->fecGrp()) grps.push_back(g->fecGrp() - 1);
       }
+      _fecGrps.refine(_simEngine, words, grps);
    }
-   for (size_t i = 0, n = _fecGrps.size(); i < n; ++i) {
-      delete _fecGrps[i];
-   }
-   // remove single
-   _fecGrps.clear();
-   for (auto it = tmpList.begin(); it != tmpList.end(); ++it) {
-      if ((*it)->size() < 2) {
-         for (auto itt = (*it)->begin(); itt != (*it)->end(); ++itt) {
-            (*itt)->setGrp(0, 0);
-         }
-         delete (*it);
-      }
-      else {
-         _fecGrps.push_back(*it);
-      }
+   else {
+      loadSimValues(words);
+      _fecGrps.refine(_simEngine, words);
    }
-   tmpList.clear();
-   
+
    size_t ss = _fecGrps.size();
    if (p) cout << char(13) << "Total #FEC Group = " << ss <<flush;
 
    return ss;
 }
 
+void
+CirMgr::initSim(size_t words)
+{
+   if (!_simEngine.isCompiled())
+      _simEngine.compile(_dfsList, _aig);
+   _simEngine.setWords(words);
+}
+
+// Keep the simulation buffer below SIM_MAX_VALUES words
+size_t
+CirMgr::simWords() const
+{
+   size_t w = SIM_MAX_VALUES / _gateList.size();
+   if (w > SIM_WORDS) w = SIM_WORDS;
+   return w? w: 1;
+}
+
+// CirGate::getSimValue() reports the last simulated word
+void
+CirMgr::loadSimValues(size_t words)
+{
+   for (size_t i = 0, n = _dfsList.size(); i < n; ++i)
+      _dfsList[i]->setSimValue(_simEngine[_dfsList[i]->getID()][words - 1]);
+   _gateList[0]->setSimValue(0);
+}
+
 unsigned
 CirMgr::maxFail(size_t s)
 {
@@ -179,49 +183,39 @@ CirMgr::maxFail(size_t s)
    else return (unsigned)(log(s) / log(5));
 }
 
+// The initial group holds CONST0 and all AIG gates in the DFS list
 bool
 CirMgr::initFecGrps()
 {
    if (!_fecGrps.empty()) return false;
 
-   GateList* fecGrp = new GateList();
-   fecGrp->push_back(_gateList[0]);
-   for (size_t i = 0, n = _dfsList.size(); i < n; ++i) {
-      if (_dfsList[i]->getType() == AIG_GATE) {
-         fecGrp->push_back(_dfsList[i]);
-      }
+   GateList fecGrp;
+   fecGrp.push_back(_gateList[0]);
+   for (size_t i = 1, n = _header.m + 1; i < n; ++i) {
+      CirGate* g = _gateList[i];
+      if (g && g->getType() == AIG_GATE && g->inDfs())
+         fecGrp.push_back(g);
    }
-   sort(fecGrp->begin(), fecGrp->end(), [](CirGate* a, CirGate* b) { return a->getID() < b->getID(); });
-   _fecGrps.push_back(fecGrp);
+   _fecGrps.init(fecGrp);
    return true;
 }
 
 void
-CirMgr::writeLog(size_t size)
+CirMgr::writeLog(size_t patterns)
 {
    if (!_simLog) return;
-   size_t mask = 1;
-   for (size_t i = 0; i < size; ++i) {
+   for (size_t p = 0; p < patterns; ++p) {
+      size_t k = p / SIZE_T;
+      size_t mask = (size_t)1 << (p % SIZE_T);
       for (size_t j = 0, m = _PIOrder.size(); j < m; ++j) {
-         if (_gateList[_PIOrder[j]]->getSimValue() & mask) *_simLog << 1;
+         if (_simEngine[_PIOrder[j]][k] & mask) *_simLog << 1;
          else *_simLog << 0;
       }
       *_simLog << ' ';
       for (size_t j = _header.m + 1, m = _gateList.size(); j < m; ++j) {
-         if (_gateList[j]->getSimValue() & mask) *_simLog << 1;
+         if (_simEngine[j][k] & mask) *_simLog << 1;
          else *_simLog << 0;
       }
       *_simLog << endl;
-      mask <<= 1;
-   }
-}
-
-void
-CirMgr::setFecGrp()
-{
-   for (size_t i = 0, n = _fecGrps.size(); i < n; ++i) {
-      for (size_t j = 0, m = _fecGrps[i]->size(); j < m; ++j) {
-         _fecGrps[i]->at(j)->setGrp(_fecGrps[i], j);
-      }
    }
 }
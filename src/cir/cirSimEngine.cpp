@@ -0,0 +1,377 @@
+/****************************************************************************
+  FileName     [ cirSimEngine.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the bit-parallel simulation engine ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include "cirSimEngine.h"
+#include "cirGate.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CIR_SIM_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/*******************************************/
+/*   class CirSimEngine member functions   */
+/*******************************************/
+// One row per variable of "aig"
+void
+CirSimEngine::compile(const GateList& dfsList, const CirAig& aig)
+{
+   const size_t rows = aig.size();
+   _nodes.clear();
+   _levelNodes.clear();
+   _nodeLevel.clear();
+   _foBegin.clear();
+   _nodes.reserve(dfsList.size());
+   for (size_t i = 0, n = dfsList.size(); i < n; ++i) {
+      CirGate* g = dfsList[i];
+      SimNode node;
+      node._out = g->getID();
+      if (g->getType() == AIG_GATE) {
+         node._lit0 = aig.lit(node._out, 0);
+         node._lit1 = aig.lit(node._out, 1);
+      }
+      else if (g->getType() == PO_GATE) {
+         node._lit0 = aig.lit(node._out, 0);
+         node._lit1 = 1; // CONST1
+      }
+      else continue;
+      _nodes.push_back(node);
+   }
+   if (rows != _rows) {
+      _rows = rows;
+      resetValues();
+   }
+   _compiled = true;
+}
+
+void
+CirSimEngine::setWords(size_t w)
+{
+   assert(w > 0);
+   if (w == _words) return;
+   _words = w;
+   resetValues();
+}
+
+void
+CirSimEngine::setInput(unsigned id, size_t k, size_t value)
+{
+   size_t& word = _values[id * _words + k];
+   if (word == value) return;
+   word = value;
+   if (!_eventMark[id]) {
+      _eventMark[id] = true;
+      _events.push_back(id);
+   }
+}
+
+bool
+CirSimEngine::simulate(size_t active, SimType t)
+{
+   assert(_compiled && active <= _words);
+   const size_t last = _active;
+   _active = active;
+   if (t == EVENT_DRIVEN && active <= _synced) {
+      simEvents(active);
+      return active == last;
+   }
+   for (size_t i = 0, n = _events.size(); i < n; ++i)
+      _eventMark[_events[i]] = false;
+   _events.clear();
+   _synced = active;
+   if (_nodes.empty()) return false;
+   const size_t nt = _pool.size();
+   if (nt == 1) {
+      _simFunc(&_nodes[0], _nodes.size(), &_values[0], _words, active);
+      return false;
+   }
+   if (active < nt) { simLevels(active); return false; }
+   // each thread owns a slice of words; a slice is simulated like a
+   // narrower engine whose rows start at word "b"
+   _pool.run([this, nt, active](size_t tid) {
+      size_t b = active * tid / nt, e = active * (tid + 1) / nt;
+      if (b < e)
+         _simFunc(&_nodes[0], _nodes.size(), &_values[b], _words, e - b);
+   });
+   return false;
+}
+
+bool
+CirSimEngine::isSupported(SimKernel k)
+{
+   switch (k) {
+      case SIM_AUTO:
+      case SIM_SCALAR: return true;
+#ifdef CIR_SIM_X86
+      case SIM_AVX2:   return __builtin_cpu_supports("avx2");
+      case SIM_AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+      default:         return false;
+   }
+}
+
+const char*
+CirSimEngine::kernelStr(SimKernel k)
+{
+   switch (k) {
+      case SIM_AUTO:   return "auto";
+      case SIM_SCALAR: return "scalar";
+      case SIM_AVX2:   return "avx2";
+      case SIM_AVX512: return "avx512";
+      default:         return "unknown";
+   }
+}
+
+// SIM_AUTO resolves to the widest kernel supported by the CPU
+bool
+CirSimEngine::setKernel(SimKernel k)
+{
+   if (k == SIM_AUTO) {
+      if (isSupported(SIM_AVX512)) k = SIM_AVX512;
+      else if (isSupported(SIM_AVX2)) k = SIM_AVX2;
+      else k = SIM_SCALAR;
+   }
+   if (!isSupported(k)) return false;
+   _kernel = k;
+   switch (k) {
+      case SIM_AVX512: _simFunc = simAvx512; break;
+      case SIM_AVX2:   _simFunc = simAvx2;   break;
+      default:         _simFunc = simScalar; break;
+   }
+   return true;
+}
+
+/*************************************/
+/*   AND-inverter simulation kernels */
+/*************************************/
+// out = (s0 ^ m0) & (s1 ^ m1), where m0/m1 are all-one masks for inversion
+void
+CirSimEngine::simScalar(const SimNode* nodes, size_t n, size_t* v,
+                        size_t w, size_t active)
+{
+   for (size_t i = 0; i < n; ++i) {
+      const SimNode& node = nodes[i];
+      const size_t* s0 = v + (node._lit0 >> 1) * w;
+      const size_t* s1 = v + (node._lit1 >> 1) * w;
+      const size_t m0 = -(size_t)(node._lit0 & 1);
+      const size_t m1 = -(size_t)(node._lit1 & 1);
+      size_t* out = v + node._out * w;
+      for (size_t k = 0; k < active; ++k)
+         out[k] = (s0[k] ^ m0) & (s1[k] ^ m1);
+   }
+}
+
+#ifdef CIR_SIM_X86
+__attribute__((target("avx2"))) void
+CirSimEngine::simAvx2(const SimNode* nodes, size_t n, size_t* v,
+                      size_t w, size_t active)
+{
+   for (size_t i = 0; i < n; ++i) {
+      const SimNode& node = nodes[i];
+      const size_t* s0 = v + (node._lit0 >> 1) * w;
+      const size_t* s1 = v + (node._lit1 >> 1) * w;
+      const size_t m0 = -(size_t)(node._lit0 & 1);
+      const size_t m1 = -(size_t)(node._lit1 & 1);
+      size_t* out = v + node._out * w;
+      const __m256i x0 = _mm256_set1_epi64x((long long)m0);
+      const __m256i x1 = _mm256_set1_epi64x((long long)m1);
+      size_t k = 0;
+      for (; k + 4 <= active; k += 4) {
+         __m256i a = _mm256_loadu_si256((const __m256i*)(s0 + k));
+         __m256i b = _mm256_loadu_si256((const __m256i*)(s1 + k));
+         _mm256_storeu_si256((__m256i*)(out + k),
+            _mm256_and_si256(_mm256_xor_si256(a, x0), _mm256_xor_si256(b, x1)));
+      }
+      for (; k < active; ++k)
+         out[k] = (s0[k] ^ m0) & (s1[k] ^ m1);
+   }
+}
+
+__attribute__((target("avx512f"))) void
+CirSimEngine::simAvx512(const SimNode* nodes, size_t n, size_t* v,
+                        size_t w, size_t active)
+{
+   for (size_t i = 0; i < n; ++i) {
+      const SimNode& node = nodes[i];
+      const size_t* s0 = v + (node._lit0 >> 1) * w;
+      const size_t* s1 = v + (node._lit1 >> 1) * w;
+      const size_t m0 = -(size_t)(node._lit0 & 1);
+      const size_t m1 = -(size_t)(node._lit1 & 1);
+      size_t* out = v + node._out * w;
+      const __m512i x0 = _mm512_set1_epi64((long long)m0);
+      const __m512i x1 = _mm512_set1_epi64((long long)m1);
+      size_t k = 0;
+      for (; k + 8 <= active; k += 8) {
+         __m512i a = _mm512_loadu_si512((const void*)(s0 + k));
+         __m512i b = _mm512_loadu_si512((const void*)(s1 + k));
+         _mm512_storeu_si512((void*)(out + k),
+            _mm512_and_si512(_mm512_xor_si512(a, x0), _mm512_xor_si512(b, x1)));
+      }
+      for (; k < active; ++k)
+         out[k] = (s0[k] ^ m0) & (s1[k] ^ m1);
+   }
+}
+#else
+// never selected: isSupported() rejects the vector kernels
+void
+CirSimEngine::simAvx2(const SimNode* nodes, size_t n, size_t* v,
+                      size_t w, size_t active)
+{
+   simScalar(nodes, n, v, w, active);
+}
+
+void
+CirSimEngine::simAvx512(const SimNode* nodes, size_t n, size_t* v,
+                        size_t w, size_t active)
+{
+   simScalar(nodes, n, v, w, active);
+}
+#endif
+
+// PI/CONST are level 0
+void
+CirSimEngine::computeLevels()
+{
+   vector<unsigned> level(_rows, 0);
+   _nodeLevel.resize(_nodes.size());
+   for (size_t i = 0, n = _nodes.size(); i < n; ++i) {
+      const SimNode& node = _nodes[i];
+      unsigned l0 = level[node._lit0 >> 1], l1 = level[node._lit1 >> 1];
+      _nodeLevel[i] = level[node._out] = (l0 > l1 ? l0 : l1) + 1;
+   }
+}
+
+// Stable counting sort of _nodes by level
+void
+CirSimEngine::levelize()
+{
+   if (_nodeLevel.empty()) computeLevels();
+   unsigned maxLevel = 0;
+   for (size_t i = 0, n = _nodeLevel.size(); i < n; ++i)
+      if (_nodeLevel[i] > maxLevel) maxLevel = _nodeLevel[i];
+   _levelBegin.assign(maxLevel + 2, 0);
+   for (size_t i = 0, n = _nodes.size(); i < n; ++i)
+      ++_levelBegin[_nodeLevel[i] + 1];
+   for (size_t l = 1; l < _levelBegin.size(); ++l)
+      _levelBegin[l] += _levelBegin[l - 1];
+   vector<size_t> pos(_levelBegin.begin(), _levelBegin.end() - 1);
+   _levelNodes.resize(_nodes.size());
+   for (size_t i = 0, n = _nodes.size(); i < n; ++i)
+      _levelNodes[pos[_nodeLevel[i]]++] = _nodes[i];
+}
+
+// Gates in the same level do not depend on each other, so a wide level is
+// split across the threads; consecutive narrow levels are simulated by the
+// calling thread in one batch.
+void
+CirSimEngine::simLevels(size_t active)
+{
+   if (_levelNodes.empty()) levelize();
+   const size_t t = _pool.size(), grain = t * SIM_LEVEL_GRAIN;
+   const SimNode* nodes = &_levelNodes[0];
+   size_t* v = &_values[0];
+   size_t l = 0, nl = _levelBegin.size() - 1;
+   while (l < nl) {
+      size_t b = _levelBegin[l], e = _levelBegin[l + 1];
+      if (e - b < grain) {
+         while (l + 1 < nl &&
+                _levelBegin[l + 2] - _levelBegin[l + 1] < grain) ++l;
+         e = _levelBegin[++l];
+         if (b < e) _simFunc(nodes + b, e - b, v, _words, active);
+         continue;
+      }
+      _pool.run([this, nodes, v, b, e, t, active](size_t tid) {
+         size_t lb = b + (e - b) * tid / t, le = b + (e - b) * (tid + 1) / t;
+         if (lb < le) _simFunc(nodes + lb, le - lb, v, _words, active);
+      });
+      ++l;
+   }
+}
+
+// _fanouts[_foBegin[id] .. _foBegin[id+1]) are the records reading row "id"
+void
+CirSimEngine::buildFanouts()
+{
+   if (_nodeLevel.empty()) computeLevels();
+   _foBegin.assign(_rows + 1, 0);
+   for (size_t i = 0, n = _nodes.size(); i < n; ++i) {
+      ++_foBegin[(_nodes[i]._lit0 >> 1) + 1];
+      ++_foBegin[(_nodes[i]._lit1 >> 1) + 1];
+   }
+   for (size_t i = 1; i <= _rows; ++i)
+      _foBegin[i] += _foBegin[i - 1];
+   vector<unsigned> pos(_foBegin.begin(), _foBegin.end() - 1);
+   _fanouts.resize(_foBegin[_rows]);
+   for (size_t i = 0, n = _nodes.size(); i < n; ++i) {
+      _fanouts[pos[_nodes[i]._lit0 >> 1]++] = i;
+      _fanouts[pos[_nodes[i]._lit1 >> 1]++] = i;
+   }
+   unsigned maxLevel = 0;
+   for (size_t i = 0, n = _nodeLevel.size(); i < n; ++i)
+      if (_nodeLevel[i] > maxLevel) maxLevel = _nodeLevel[i];
+   _queue.assign(maxLevel + 1, vector<unsigned>());
+   _queued.assign(_nodes.size(), false);
+}
+
+void
+CirSimEngine::schedule(unsigned id)
+{
+   for (unsigned i = _foBegin[id], n = _foBegin[id + 1]; i < n; ++i) {
+      unsigned j = _fanouts[i];
+      if (_queued[j]) continue;
+      _queued[j] = true;
+      _queue[_nodeLevel[j]].push_back(j);
+   }
+}
+
+// A record is evaluated after all of its fanins since they have lower
+// levels, so each record is evaluated at most once. The input rows and
+// the records whose values change are kept in _changed.
+void
+CirSimEngine::simEvents(size_t active)
+{
+   if (_foBegin.empty()) buildFanouts();
+   for (size_t i = 0, n = _events.size(); i < n; ++i) {
+      _eventMark[_events[i]] = false;
+      schedule(_events[i]);
+   }
+   _changed.swap(_events);
+   _events.clear();
+   _old.resize(_words);
+   size_t* v = &_values[0];
+   for (size_t l = 1, nl = _queue.size(); l < nl; ++l) {
+      vector<unsigned>& q = _queue[l];
+      for (size_t i = 0, n = q.size(); i < n; ++i) {
+         const SimNode& node = _nodes[q[i]];
+         _queued[q[i]] = false;
+         size_t* out = v + node._out * _words;
+         copy(out, out + active, _old.begin());
+         _simFunc(&node, 1, v, _words, active);
+         if (equal(out, out + active, _old.begin())) continue;
+         _changed.push_back(node._out);
+         schedule(node._out);
+      }
+      q.clear();
+   }
+}
+
+// Rows of CONST0 and UNDEF gates are never written, so they stay 0
+void
+CirSimEngine::resetValues()
+{
+   vector<size_t> tmp(_rows * _words, 0);
+   _values.swap(tmp);
+   _synced = 0;
+   _active = 0;
+   _events.clear();
+   _eventMark.assign(_rows, false);
+}
@@ -0,0 +1,120 @@
+/****************************************************************************
+  FileName     [ cirSimEngine.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the bit-parallel simulation engine ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_SIM_ENGINE_H
+#define CIR_SIM_ENGINE_H
+
+#include <vector>
+#include "cirDef.h"
+#include "cirAig.h"
+#include "cirThread.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   class CirSimEngine
+//------------------------------------------------------------------------
+// The DFS order is compiled into a flat array of AND records whose fanins
+// are AIGER-style literals (id * 2 + inverted). Each gate id owns a row of
+// "words()" machine words, so one pass evaluates words() * SIZE_T patterns
+// per gate without touching the CirGate objects.
+// A PO is compiled as "fanin & CONST1" so that all records share one kernel.
+// The AND-inverter kernel is picked at run time among the SimKernel
+// variants supported by the CPU (SIM_AUTO selects the widest one).
+// With more than one thread, the active words are partitioned across the
+// threads when there are enough of them; otherwise the records are grouped
+// by logic level and each wide level is split across the threads.
+// In EVENT_DRIVEN mode only the records in the fanout cones of the rows
+// changed through setInput() are re-evaluated, in level order, and an event
+// stops at a record whose value does not change. The values survive
+// compile() since every netlist edit in CirMgr keeps the function of the
+// remaining gates; writing a row through operator[] requires an ALL_GATE
+// simulation before the next EVENT_DRIVEN one.
+class CirSimEngine
+{
+public:
+   CirSimEngine(): _rows(0), _words(0), _synced(0), _active(0),
+                   _compiled(false) {
+      setKernel(SIM_AUTO);
+   }
+   ~CirSimEngine() {}
+
+   static bool isSupported(SimKernel k);
+   static const char* kernelStr(SimKernel k);
+   bool setKernel(SimKernel k);
+   SimKernel getKernel() const { return _kernel; }
+
+   void setThreads(size_t n) { _pool.resize(n); }
+   size_t threads() const { return _pool.size(); }
+
+   void compile(const GateList& dfsList, const CirAig& aig);
+   void invalidate() { _compiled = false; }
+   bool isCompiled() const { return _compiled; }
+
+   void setWords(size_t w);
+   size_t words() const { return _words; }
+
+   size_t* operator [] (unsigned id) { return &_values[id * _words]; }
+   const size_t* operator [] (unsigned id) const {
+      return &_values[id * _words];
+   }
+
+   // writes word "k" of row "id" and records an event if it is changed
+   void setInput(unsigned id, size_t k, size_t value);
+   // only the first "active" words of each row are evaluated; returns
+   // true if it is an event-driven pass with the "active" of the last
+   // one, so the rows in changed() are the only ones it changed
+   bool simulate(size_t active, SimType t = ALL_GATE);
+   const vector<unsigned>& changed() const { return _changed; }
+
+private:
+   struct SimNode {
+      unsigned _out;
+      unsigned _lit0;
+      unsigned _lit1;
+   };
+   typedef void (*SimFunc)(const SimNode*, size_t, size_t*, size_t, size_t);
+
+   static void simScalar(const SimNode*, size_t, size_t*, size_t, size_t);
+   static void simAvx2(const SimNode*, size_t, size_t*, size_t, size_t);
+   static void simAvx512(const SimNode*, size_t, size_t*, size_t, size_t);
+
+   vector<SimNode>   _nodes;       // in DFS order
+   vector<SimNode>   _levelNodes;  // sorted by level; built on demand
+   vector<size_t>    _levelBegin;  // _levelNodes offset of each level
+   vector<unsigned>  _nodeLevel;   // level of each record in _nodes
+   vector<size_t>    _values;
+   size_t            _rows;
+   size_t            _words;
+   size_t            _synced;      // #words consistent with the inputs
+   size_t            _active;      // of the last simulate()
+
+   // event-driven simulation; built on demand
+   vector<unsigned>           _foBegin;   // CSR fanout records of each row
+   vector<unsigned>           _fanouts;
+   vector<unsigned>           _events;    // rows changed by setInput()
+   vector<bool>               _eventMark;
+   vector<vector<unsigned> >  _queue;     // pending records of each level
+   vector<bool>               _queued;
+   vector<size_t>             _old;
+   vector<unsigned>           _changed;   // rows changed by simEvents()
+   bool              _compiled;
+   SimKernel         _kernel;
+   SimFunc           _simFunc;
+   CirThreadPool     _pool;
+
+   void computeLevels();
+   void levelize();
+   void simLevels(size_t active);
+   void buildFanouts();
+   void simEvents(size_t active);
+   void schedule(unsigned id);
+   void resetValues();
+};
+
+#endif // CIR_SIM_ENGINE_H
@@ -0,0 +1,100 @@
+/****************************************************************************
+  FileName     [ cirStrash.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the structural hash table of AND gates ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include "cirStrash.h"
+
+using namespace std;
+
+// #slots of _old moved to _table by each insert(); with the table grown
+// at half load, _old is empty long before the next growth
+static const size_t STRASH_MOVES = 4;
+
+/*********************************************/
+/*   class CirStrashTable member functions   */
+/*********************************************/
+void
+CirStrashTable::init(size_t n)
+{
+   size_t cap = 16;
+   while (cap < n * 2) cap <<= 1;
+   Slot empty = { EMPTY, 0 };
+   _table.assign(cap, empty);
+   vector<Slot>().swap(_old);
+   _size = _move = 0;
+}
+
+unsigned
+CirStrashTable::find(unsigned l0, unsigned l1) const
+{
+   const unsigned long long k = key(l0, l1);
+   const Slot* s = lookup(_table, k);
+   if (!s && !_old.empty()) s = lookup(_old, k);
+   return s? s->var: 0;
+}
+
+unsigned
+CirStrashTable::insert(unsigned l0, unsigned l1, unsigned v)
+{
+   assert(v);
+   const unsigned long long k = key(l0, l1);
+   if (!_old.empty()) {
+      const Slot* s = lookup(_old, k);
+      if (s) return s->var;
+   }
+   Slot* s = place(_table, k);
+   if (s->key == k) return s->var;
+   s->key = k;
+   s->var = v;
+   if (++_size * 2 > _table.size()) grow();
+   else if (!_old.empty()) migrate(STRASH_MOVES);
+   return 0;
+}
+
+// The slot of k in t, or 0 if k is not there
+const CirStrashTable::Slot*
+CirStrashTable::lookup(const vector<Slot>& t, unsigned long long k)
+{
+   const size_t mask = t.size() - 1;
+   for (size_t i = hash(k) & mask; ; i = (i + 1) & mask) {
+      if (t[i].key == k) return &t[i];
+      if (t[i].key == EMPTY) return 0;
+   }
+}
+
+// The slot of k in t if it is there, or else the empty slot to put it in
+CirStrashTable::Slot*
+CirStrashTable::place(vector<Slot>& t, unsigned long long k)
+{
+   const size_t mask = t.size() - 1;
+   size_t i = hash(k) & mask;
+   while (t[i].key != k && t[i].key != EMPTY) i = (i + 1) & mask;
+   return &t[i];
+}
+
+void
+CirStrashTable::grow()
+{
+   if (!_old.empty()) migrate(_old.size());
+   Slot empty = { EMPTY, 0 };
+   _old.swap(_table);
+   _table.assign(_old.size() * 2, empty);
+   _move = 0;
+}
+
+// Move the entries of the next n slots of _old to _table
+void
+CirStrashTable::migrate(size_t n)
+{
+   for (size_t e = _old.size(); n && _move < e; --n, ++_move) {
+      const Slot& o = _old[_move];
+      if (o.key == EMPTY) continue;
+      *place(_table, o.key) = o;
+   }
+   if (_move == _old.size()) vector<Slot>().swap(_old);
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+  FileName     [ cirStrash.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the structural hash table of AND gates ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_STRASH_H
+#define CIR_STRASH_H
+
+#include <vector>
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   class CirStrashTable
+//------------------------------------------------------------------------
+// Maps the (unordered) fanin literal pair of an AND gate to its variable.
+// The pair is packed into one 64-bit key, which is mixed by the finalizer
+// of MurmurHash3 and looked up by linear probing in a power-of-two table,
+// so a lookup usually touches a single cache line.
+// The table doubles at half load, but the entries of the old table are
+// moved a few per insert() instead of all at once, and lookups check both
+// tables meanwhile; an insert never pays for a whole rehash.
+// Variable 0 is the constant and never an AND gate, so 0 means "none".
+class CirStrashTable
+{
+public:
+   CirStrashTable() { init(0); }
+   ~CirStrashTable() {}
+
+   // empty the table and make room for about n gates
+   void init(size_t n);
+   void clear() { init(0); }
+   size_t size() const { return _size; }
+
+   // the gate of fanins (l0, l1); 0 if there is none
+   unsigned find(unsigned l0, unsigned l1) const;
+   // add gate v of fanins (l0, l1) and return 0, or return the gate that
+   // is already there and leave the table unchanged
+   unsigned insert(unsigned l0, unsigned l1, unsigned v);
+
+private:
+   struct Slot
+   {
+      unsigned long long   key;
+      unsigned             var;
+   };
+
+   vector<Slot>   _table;
+   vector<Slot>   _old;     // the table before the last growth
+   size_t         _size;    // #entries in both tables
+   size_t         _move;    // next slot of _old to move
+
+   static const unsigned long long EMPTY = ~0ull;
+
+   static unsigned long long key(unsigned l0, unsigned l1) {
+      return l0 < l1? (unsigned long long)l1 << 32 | l0:
+                      (unsigned long long)l0 << 32 | l1;
+   }
+   static size_t hash(unsigned long long k) {
+      k ^= k >> 33; k *= 0xff51afd7ed558ccdull;
+      k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53ull;
+      k ^= k >> 33;
+      return size_t(k);
+   }
+   static const Slot* lookup(const vector<Slot>& t, unsigned long long k);
+   static Slot* place(vector<Slot>& t, unsigned long long k);
+   void grow();
+   void migrate(size_t n);
+};
+
+#endif // CIR_STRASH_H
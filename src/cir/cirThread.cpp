@@ -0,0 +1,66 @@
+/****************************************************************************
+  FileName     [ cirThread.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define a minimal fork-join thread pool ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include "cirThread.h"
+
+using namespace std;
+
+/********************************************/
+/*   class CirThreadPool member functions   */
+/********************************************/
+void
+CirThreadPool::resize(size_t n)
+{
+   assert(n > 0);
+   if (n == size()) return;
+   {
+      lock_guard<mutex> lk(_mutex);
+      _stop = true;
+   }
+   _start.notify_all();
+   for (size_t i = 0, m = _workers.size(); i < m; ++i)
+      _workers[i].join();
+   _workers.clear();
+   _stop = false;
+   for (size_t i = 1; i < n; ++i)
+      _workers.push_back(thread(&CirThreadPool::work, this, i, _gen));
+}
+
+void
+CirThreadPool::run(const Job& job)
+{
+   if (_workers.empty()) { job(0); return; }
+   {
+      lock_guard<mutex> lk(_mutex);
+      _job = &job;
+      _pending = _workers.size();
+      ++_gen;
+   }
+   _start.notify_all();
+   job(0);
+   unique_lock<mutex> lk(_mutex);
+   _done.wait(lk, [this] { return _pending == 0; });
+   _job = 0;
+}
+
+void
+CirThreadPool::work(size_t tid, size_t gen)
+{
+   for (;;) {
+      unique_lock<mutex> lk(_mutex);
+      _start.wait(lk, [this, gen] { return _stop || _gen != gen; });
+      if (_stop) return;
+      gen = _gen;
+      const Job* job = _job;
+      lk.unlock();
+      (*job)(tid);
+      lk.lock();
+      if (--_pending == 0) _done.notify_one();
+   }
+}
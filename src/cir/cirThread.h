@@ -0,0 +1,51 @@
+/****************************************************************************
+  FileName     [ cirThread.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define a minimal fork-join thread pool ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_THREAD_H
+#define CIR_THREAD_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   class CirThreadPool
+//------------------------------------------------------------------------
+// run(job) calls job(tid) for tid = 0 .. size()-1 and returns when all of
+// them are done. tid 0 is executed by the calling thread, so a pool of
+// size 1 has no worker thread at all.
+class CirThreadPool
+{
+public:
+   typedef function<void(size_t)> Job;
+
+   CirThreadPool(): _job(0), _gen(0), _pending(0), _stop(false) {}
+   ~CirThreadPool() { resize(1); }
+
+   void resize(size_t n);
+   size_t size() const { return _workers.size() + 1; }
+   void run(const Job& job);
+
+private:
+   vector<thread>       _workers;
+   const Job*           _job;
+   size_t               _gen;      // incremented for each run()
+   size_t               _pending;  // #workers still running the job
+   bool                 _stop;
+   mutex                _mutex;
+   condition_variable   _start;
+   condition_variable   _done;
+
+   void work(size_t tid, size_t gen);
+};
+
+#endif // CIR_THREAD_H
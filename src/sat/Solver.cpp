@@ -23,15 +23,19 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 int effLimit = INT_MAX;
 
+// 'restart_lbd' restarts once the average LBD of the last 50 learnt clauses, times this factor, exceeds
+// the overall average:
+static const double lbd_restart_k = 0.8;
+
 //=================================================================================================
 // Helper functions:
 
 
-void removeWatch(vec<Clause*>& ws, Clause* elem)
+void removeWatch(vec<Watcher>& ws, CRef elem)
 {
     if (ws.size() == 0) return;     // (skip lists that are already cleared)
     int j = 0;
-    for (; ws[j] != elem  ; j++) assert(j < ws.size());
+    for (; ws[j].cref != elem; j++) assert(j < ws.size());
     for (; j < ws.size()-1; j++) ws[j] = ws[j+1];
     ws.pop();
 }
@@ -106,7 +110,8 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
 
     }else{
         // Allocate clause:
-        Clause* c   = Clause_new(learnt, ps, id);
+        CRef    cr  = ca.alloc(ps, learnt, id);
+        Clause& c   = ca[cr];
 
         if (learnt){
             // Put the second watch on the literal with highest decision level:
@@ -116,47 +121,57 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
                 if (level[var(ps[i])] > max)
                     max   = level[var(ps[i])],
                     max_i = i;
-            (*c)[1]     = ps[max_i];
-            (*c)[max_i] = ps[1];
+            c[1]     = ps[max_i];
+            c[max_i] = ps[1];
 
             // Bumping:
             claBumpActivity(c); // (newly learnt clauses should be considered active)
 
             // Enqueue asserting literal:
-            check(enqueue((*c)[0], c));
+            check(enqueue(c[0], cr));
 
             // Store clause:
-            watches[index(~(*c)[0])].push(c);
-            watches[index(~(*c)[1])].push(c);
-            learnts.push(c);
-            stats.learnts_literals += c->size();
+            attach(cr);
+            learnts.push(cr);
+            stats.learnts_literals += c.size();
 
         }else{
             // Store clause:
-            watches[index(~(*c)[0])].push(c);
-            watches[index(~(*c)[1])].push(c);
-            clauses.push(c);
-            stats.clauses_literals += c->size();
+            attach(cr);
+            clauses.push(cr);
+            stats.clauses_literals += c.size();
         }
     }
 }
 
 
+// Puts a clause in the watcher lists of its first two literals. A binary clause goes to 'watchesBin[]'
+// and is never read by 'propagate()'; a longer clause is blocked by its other watch.
+//
+void Solver::attach(CRef cr)
+{
+    const Clause& c = ca[cr];
+    vec<vec<Watcher> >& ws = c.size() == 2 ? watchesBin : watches;
+    ws[index(~c[0])].push(Watcher(cr, c[1]));
+    ws[index(~c[1])].push(Watcher(cr, c[0]));
+}
+
+
 // Disposes a clauses and removes it from watcher lists. NOTE! Low-level; does NOT change the 'clauses' and 'learnts' vector.
 //
-void Solver::remove(Clause* c, bool just_dealloc)
+void Solver::remove(CRef cr)
 {
-    if (!just_dealloc){
-        removeWatch(watches[index(~(*c)[0])], c),
-        removeWatch(watches[index(~(*c)[1])], c);
+    Clause& c = ca[cr];
+    vec<vec<Watcher> >& ws = c.size() == 2 ? watchesBin : watches;
+    removeWatch(ws[index(~c[0])], cr),
+    removeWatch(ws[index(~c[1])], cr);
 
-        if (c->learnt()) stats.learnts_literals -= c->size();
-        else             stats.clauses_literals -= c->size();
+    if (c.learnt()) stats.learnts_literals -= c.size();
+    else            stats.clauses_literals -= c.size();
 
-        if (proof != NULL) proof->deleted(c->id());
-    }
+    if (proof != NULL) proof->deleted(c.id());
 
-    xfree(c);
+    ca.free(cr);
 }
 
 
@@ -164,11 +179,11 @@ void Solver::remove(Clause* c, bool just_dealloc)
 // the clause is binary and satisfied, in which case the first literal is true)
 // Returns True if clause is satisfied (will be removed), False otherwise.
 //
-bool Solver::simplify(Clause* c) const
+bool Solver::simplify(const Clause& c) const
 {
     assert(decisionLevel() == 0);
-    for (int i = 0; i < c->size(); i++){
-        if (value((*c)[i]) == l_True)
+    for (int i = 0; i < c.size(); i++){
+        if (value(c[i]) == l_True)
             return true;
     }
     return false;
@@ -179,28 +194,74 @@ bool Solver::simplify(Clause* c) const
 // Minor methods:
 
 
-// Creates a new SAT variable in the solver. If 'decision_var' is cleared, variable will not be
+// Creates a new SAT variable in the solver. If 'dvar' is cleared, variable will not be
 // used as a decision variable (NOTE! This has effects on the meaning of a SATISFIABLE result).
 //
-Var Solver::newVar() {
+Var Solver::newVar(bool dvar) {
+    if (free_vars.size() > 0){
+        // Reuse a variable freed by 'simplifyDB()'; it is unassigned and in no clause:
+        Var v = free_vars.last(); free_vars.pop();
+        decision[v]    = (char)dvar;
+        polarity[v]    = 1;
+        gate_in[2*v]   = lit_Undef;
+        gate_in[2*v+1] = lit_Undef;
+        jgate[v]       = 0;
+        if (dvar) order.undo(v);
+        return v; }
     int     index;
     index = nVars();
     watches     .push();          // (list for positive literal)
     watches     .push();          // (list for negative literal)
-    reason      .push(NULL);
+    watchesBin  .push();
+    watchesBin  .push();
+    reason      .push(CRef_Undef);
     assigns     .push(toInt(l_Undef));
     level       .push(-1);
     trail_pos   .push(-1);
     activity    .push(0);
+    decision    .push((char)dvar);
+    polarity    .push(1);
+    gate_in     .push(lit_Undef);
+    gate_in     .push(lit_Undef);
+    jgate       .push(0);
+    lbd_seen    .push(0);
     order       .newVar();
     analyze_seen.push(0);
     if (proof != NULL) unit_id.push(ClauseId_NULL);
     return index; }
 
 
+// Clearing the flag takes effect lazily: the variable is dropped from the order heap the next
+// time it comes up in 'order.select()'.
+//
+void Solver::setDecisionVar(Var v, bool b) {
+    decision[v] = (char)b;
+    if (b) order.undo(v); }
+
+
+// Declares 'v' to be the AND of 'a' and 'b', for 'SearchParams::justify'. The clauses of the gate
+// are NOT added here. The gate is only justified while 'setJustifyGate()' has turned it on: in an
+// incremental setting, a gate outside the current problem need not be justified even if it is FALSE.
+//
+void Solver::setGate(Var v, Lit a, Lit b) {
+    gate_in[2*v]   = a;
+    gate_in[2*v+1] = b; }
+
+
+// The clauses of 'var(p)' must all contain 'p', so that none is left once 'simplifyDB()' has removed
+// the satisfied ones; an activation literal retired by its negation is the typical case. Without
+// proof logging, the variable is then freed for 'newVar()' (see 'freeReleased()').
+//
+void Solver::releaseVar(Lit p) {
+    assert(decisionLevel() == 0);
+    addUnit(p);
+    if (proof == NULL) released_vars.push(var(p)); }
+
+
 // Returns FALSE if immediate conflict.
 bool Solver::assume(Lit p) {
     trail_lim.push(trail.size());
+    jhead_lim.push(jhead);
     return enqueue(p); }
 
 
@@ -209,11 +270,14 @@ void Solver::cancelUntil(int level) {
     if (decisionLevel() > level){
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var     x  = var(trail[c]);
-            assigns[x] = toInt(l_Undef);
-            reason [x] = NULL;
+            assigns [x] = toInt(l_Undef);
+            polarity[x] = sign(trail[c]);
+            reason  [x] = CRef_Undef;
             order.undo(x); }
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+        jhead = jhead_lim[level];
+        jhead_lim.shrink(jhead_lim.size() - level);
         qhead = trail.size(); } }
 
 
@@ -223,7 +287,7 @@ void Solver::cancelUntil(int level) {
 
 /*_________________________________________________________________________________________________
 |
-|  analyze : (confl : Clause*) (out_learnt : vec<Lit>&) (out_btlevel : int&)  ->  [void]
+|  analyze : (confl : CRef) (out_learnt : vec<Lit>&) (out_btlevel : int&)  ->  [void]
 |  
 |  Description:
 |    Analyze conflict and produce a reason clause ('out_learnt') and a backtracking level
@@ -244,7 +308,7 @@ public:
     lastToFirst_lt(const vec<int>& t) : trail_pos(t) {}
     bool operator () (Lit p, Lit q) { return trail_pos[var(p)] > trail_pos[var(q)]; }
 };
-void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
+void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
 {
     vec<char>&     seen  = analyze_seen;
     int            pathC = 0;
@@ -252,16 +316,16 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 
     // Generate conflict clause:
     //
-    if (proof != NULL) proof->beginChain(confl->id());
+    if (proof != NULL) proof->beginChain(ca[confl].id());
     out_learnt.push();          // (leave room for the asserting literal)
     out_btlevel = 0;
     int index = trail.size()-1;
     for(;;){
-        assert(confl != NULL);  // (otherwise should be UIP)
+        assert(confl != CRef_Undef);    // (otherwise should be UIP)
 
-        Clause& c = *confl;
+        Clause& c = (p == lit_Undef) ? ca[confl] : reasonClause(confl);
         if (c.learnt())
-            claBumpActivity(&c);
+            claBumpActivity(c);
 
         for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
             Lit q = c[j];
@@ -288,7 +352,7 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         pathC--;
         if (pathC == 0) break;
 
-        if (proof != NULL) proof->resolve(confl->id(), ~p);
+        if (proof != NULL) proof->resolve(ca[confl].id(), ~p);
     }
     out_learnt[0] = ~p;
 
@@ -304,18 +368,18 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 
         analyze_toclear.clear();
         for (i = j = 1; i < out_learnt.size(); i++)
-            if (reason[var(out_learnt[i])] == NULL || !analyze_removable(out_learnt[i], min_level))
+            if (reason[var(out_learnt[i])] == CRef_Undef || !analyze_removable(out_learnt[i], min_level))
                 out_learnt[j++] = out_learnt[i];
     }else if(expensive_ccmin == 1){
         // Simplify conflict clause (a little):
         //
         analyze_toclear.clear();
         for (i = j = 1; i < out_learnt.size(); i++){
-            Clause* r = reason[var(out_learnt[i])];
-            if (r == NULL)
+            CRef r = reason[var(out_learnt[i])];
+            if (r == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
             else{
-                Clause& c = *r;
+                Clause& c = reasonClause(r);
                 for (int k = 1; k < c.size(); k++)
                     if (!seen[var(c[k])] && level[var(c[k])] != 0){
                         out_learnt[j++] = out_learnt[i];
@@ -334,7 +398,7 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         for (int k = 0; k < analyze_toclear.size(); k++){
             Var     v = var(analyze_toclear[k]); assert(level[v] > 0);
 				Lit     l = analyze_toclear[k];
-            Clause& c = *reason[v];
+            Clause& c = reasonClause(reason[v]);
             proof->resolve(c.id(), l);
             for (int k = 1; k < c.size(); k++)
                 if (level[var(c[k])] == 0)
@@ -357,17 +421,17 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 //
 bool Solver::analyze_removable(Lit p, uint min_level)
 {
-    assert(reason[var(p)] != NULL);
+    assert(reason[var(p)] != CRef_Undef);
     analyze_stack.clear(); analyze_stack.push(p);
     int top = analyze_toclear.size();
     while (analyze_stack.size() > 0){
-        assert(reason[var(analyze_stack.last())] != NULL);
-        Clause& c = *reason[var(analyze_stack.last())];
+        assert(reason[var(analyze_stack.last())] != CRef_Undef);
+        Clause& c = reasonClause(reason[var(analyze_stack.last())]);
         analyze_stack.pop();
         for (int i = 1; i < c.size(); i++){
             Lit p = c[i];
             if (!analyze_seen[var(p)] && level[var(p)] != 0){
-                if (reason[var(p)] != NULL && ((1 << (level[var(p)] & 31)) & min_level) != 0){
+                if (reason[var(p)] != CRef_Undef && ((1 << (level[var(p)] & 31)) & min_level) != 0){
                     analyze_seen[var(p)] = 1;
                     analyze_stack.push(p);
                     analyze_toclear.push(p);
@@ -388,7 +452,7 @@ bool Solver::analyze_removable(Lit p, uint min_level)
 
 /*_________________________________________________________________________________________________
 |
-|  analyzeFinal : (confl : Clause*) (skip_first : bool)  ->  [void]
+|  analyzeFinal : (confl : CRef) (skip_first : bool)  ->  [void]
 |  
 |  Description:
 |    Specialized analysis procedure to express the final conflict in terms of assumptions.
@@ -396,7 +460,7 @@ bool Solver::analyze_removable(Lit p, uint min_level)
 |    making assumptions). If 'skip_first' is TRUE, the first literal of 'confl' is  ignored (needed
 |    if conflict arose before search even started).
 |________________________________________________________________________________________________@*/
-void Solver::analyzeFinal(Clause* confl, bool skip_first)
+void Solver::analyzeFinal(CRef confl, bool skip_first)
 {
     // -- NOTE! This code is relatively untested. Please report bugs!
     conflict.clear();
@@ -405,10 +469,11 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
         return; }
    //assert(false);
     vec<char>&     seen  = analyze_seen;
-    if (proof != NULL) proof->beginChain(confl->id());
-    for (int i = skip_first ? 1 : 0; i < confl->size(); i++){
-        Var     x = var((*confl)[i]);
-		  Lit		 l = (*confl)[i];
+    Clause& cf = skip_first ? reasonClause(confl) : ca[confl];
+    if (proof != NULL) proof->beginChain(cf.id());
+    for (int i = skip_first ? 1 : 0; i < cf.size(); i++){
+        Var     x = var(cf[i]);
+		  Lit		 l = cf[i];
         if (level[x] > 0)
             seen[x] = 1;
         else
@@ -420,12 +485,12 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
         Var     x = var(trail[i]);
 		  Lit     l = trail[i];
         if (seen[x]){
-            Clause* r = reason[x];
-            if (r == NULL){
+            CRef r = reason[x];
+            if (r == CRef_Undef){
                 assert(level[x] > 0);
                 conflict.push(~trail[i]);
             }else{
-                Clause& c = *r;
+                Clause& c = reasonClause(r);
                 if (proof != NULL) proof->resolve(c.id(), l);
                 for (int j = 1; j < c.size(); j++)
                     if (level[var(c[j])] > 0)
@@ -442,7 +507,7 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
 
 /*_________________________________________________________________________________________________
 |
-|  enqueue : (p : Lit) (from : Clause*)  ->  [bool]
+|  enqueue : (p : Lit) (from : CRef)  ->  [bool]
 |  
 |  Description:
 |    Puts a new fact on the propagation queue as well as immediately updating the variable's value.
@@ -451,12 +516,12 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
 |  Input:
 |    p    - The fact to enqueue
 |    from - [Optional] Fact propagated from this (currently) unit clause. Stored in 'reason[]'.
-|           Default value is NULL (no reason).
+|           Default value is 'CRef_Undef' (no reason).
 |  
 |  Output:
 |    TRUE if fact was enqueued without conflict, FALSE otherwise.
 |________________________________________________________________________________________________@*/
-bool Solver::enqueue(Lit p, Clause* from)
+bool Solver::enqueue(Lit p, CRef from)
 {
     if (value(p) != l_Undef)
         return value(p) != l_False;
@@ -475,71 +540,82 @@ bool Solver::enqueue(Lit p, Clause* from)
 
 /*_________________________________________________________________________________________________
 |
-|  propagate : [void]  ->  [Clause*]
+|  propagate : [void]  ->  [CRef]
 |  
 |  Description:
 |    Propagates all enqueued facts. If a conflict arises, the conflicting clause is returned,
-|    otherwise NULL. NOTE! This method has been optimized for speed rather than readability.
+|    otherwise 'CRef_Undef'. NOTE! This method has been optimized for speed rather than readability.
+|    Binary clauses are propagated from their watchers alone, and a longer clause is only read
+|    when the blocker literal of its watcher is not already true.
 |  
 |    Post-conditions:
 |      * The propagation queue is empty, even if there was a conflict.
 |________________________________________________________________________________________________@*/
-Clause* Solver::propagate()
+CRef Solver::propagate()
 {
-    Clause* confl = NULL;
+    CRef    confl = CRef_Undef;
     while (qhead < trail.size()){
         stats.propagations++;
         simpDB_props--;
 
         Lit            p  = trail[qhead++];     // 'p' is enqueued fact to propagate.
-        vec<Clause*>&  ws = watches[index(p)];
-        Clause**       i,** j,** end;
+        Lit            false_lit = ~p;
+
+        // Binary clauses first -- the implied literal is the blocker:
+        vec<Watcher>&  wbin = watchesBin[index(p)];
+        for (int k = 0; k < wbin.size(); k++){
+            Lit imp = wbin[k].blocker;
+            if (value(imp) == l_True) continue;
+
+            if (decisionLevel() == 0 && proof != NULL) logUnit(wbin[k].cref, imp);
+            if (!enqueue(imp, wbin[k].cref)){
+                if (decisionLevel() == 0)
+                    ok = false;
+                confl = wbin[k].cref;
+                qhead = trail.size();
+                break;
+            }
+        }
+        if (confl != CRef_Undef) break;
+
+        vec<Watcher>&  ws = watches[index(p)];
+        Watcher        *i, *j, *end;
+
+        for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
+            // If the blocker is true, the clause is already satisfied:
+            Lit blocker = i->blocker;
+            if (value(blocker) == l_True){
+                *j++ = *i++; continue; }
 
-        for (i = j = (Clause**)ws, end = i + ws.size();  i != end;){
-            Clause& c = **i; i++;
             // Make sure the false literal is data[1]:
-            Lit false_lit = ~p;
+            CRef    cr = i->cref;
+            Clause& c  = ca[cr]; i++;
             if (c[0] == false_lit)
                 c[0] = c[1], c[1] = false_lit;
 
             assert(c[1] == false_lit);
 
             // If 0th watch is true, then clause is already satisfied.
-            Lit   first = c[0];
-            lbool val   = value(first);
-            if (val == l_True){
-                *j++ = &c;
+            Lit     first = c[0];
+            Watcher w(cr, first);
+            if (first != blocker && value(first) == l_True){
+                *j++ = w;
             }else{
                 // Look for new watch:
                 for (int k = 2; k < c.size(); k++)
                     if (value(c[k]) != l_False){
                         c[1] = c[k]; c[k] = false_lit;
-                        watches[index(~c[1])].push(&c);
+                        watches[index(~c[1])].push(w);
                         goto FoundWatch; }
 
                 // Did not find watch -- clause is unit under assignment:
-                if (decisionLevel() == 0 && proof != NULL){
-                    // Log the production of this unit clause:
-                    proof->beginChain(c.id());
-                    for (int k = 1; k < c.size(); k++)
-                        proof->resolve(unit_id[var(c[k])], c[k]);
-                    ClauseId id = proof->endChain();
-                    assert(unit_id[var(first)] == ClauseId_NULL || value(first) == l_False);    // (if variable already has 'id', it must be with the other polarity and we should have derived the empty clause here)
-                    if (value(first) != l_False)
-                        unit_id[var(first)] = id;
-                    else{
-                        // Empty clause derived:
-                        proof->beginChain(unit_id[var(first)]);
-                        proof->resolve(id, ~first);
-                        proof->endChain();
-                    }
-                }
-					 
-                *j++ = &c;
-                if (!enqueue(first, &c)){
+                if (decisionLevel() == 0 && proof != NULL) logUnit(cr, first);
+
+                *j++ = w;
+                if (!enqueue(first, cr)){
                     if (decisionLevel() == 0)
                         ok = false;
-                    confl = &c;
+                    confl = cr;
                     qhead = trail.size();
                     // Copy the remaining watches:
                     while (i < end)
@@ -555,34 +631,134 @@ Clause* Solver::propagate()
 }
 
 
+// Log the production of the top-level unit 'first' by clause 'cr' (all other literals of which are false).
+//
+void Solver::logUnit(CRef cr, Lit first)
+{
+    const Clause& c = ca[cr];
+    proof->beginChain(c.id());
+    for (int k = 0; k < c.size(); k++)
+        if (c[k] != first)
+            proof->resolve(unit_id[var(c[k])], c[k]);
+    ClauseId id = proof->endChain();
+    assert(unit_id[var(first)] == ClauseId_NULL || value(first) == l_False);    // (if variable already has 'id', it must be with the other polarity and we should have derived the empty clause here)
+    if (value(first) != l_False)
+        unit_id[var(first)] = id;
+    else{
+        // Empty clause derived:
+        proof->beginChain(unit_id[var(first)]);
+        proof->resolve(id, ~first);
+        proof->endChain();
+    }
+}
+
+
+// The number of distinct decision levels among the literals of 'ps' (its "literal block distance").
+// All of them must be assigned.
+//
+int Solver::computeLBD(const vec<Lit>& ps)
+{
+    int n = 0;
+    lbd_stamp++;
+    for (int i = 0; i < ps.size(); i++){
+        int l = level[var(ps[i])];
+        if (lbd_seen[l] != lbd_stamp){
+            lbd_seen[l] = lbd_stamp;
+            n++; }
+    }
+    return n;
+}
+
+
 /*_________________________________________________________________________________________________
 |
-|  reduceDB : ()  ->  [void]
+|  reduceDB : (by_lbd : bool)  ->  [void]
 |  
 |  Description:
 |    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
 |    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|    If 'by_lbd' is TRUE, the clauses of highest LBD go first (the least active among equal LBD)
+|    and those of LBD 2 or less ("glue" clauses) are kept; otherwise, the least active ones go first,
+|    along with any clause below an activity limit.
 |________________________________________________________________________________________________@*/
-struct reduceDB_lt { bool operator () (Clause* x, Clause* y) { return x->size() > 2 && (y->size() == 2 || x->activity() < y->activity()); } };
-void Solver::reduceDB()
+struct reduceDB_lt {
+    const ClauseAllocator& ca;
+    reduceDB_lt(const ClauseAllocator& ca_) : ca(ca_) { }
+    bool operator () (CRef x, CRef y) { return ca[x].size() > 2 && (ca[y].size() == 2 || ca[x].activity() < ca[y].activity()); } };
+struct reduceDB_lbd_lt {
+    const ClauseAllocator& ca;
+    reduceDB_lbd_lt(const ClauseAllocator& ca_) : ca(ca_) { }
+    bool operator () (CRef x, CRef y) {
+        const Clause& a = ca[x];
+        const Clause& b = ca[y];
+        if (a.size() == 2 || b.size() == 2) return a.size() > 2 && b.size() == 2;
+        return a.lbd() > b.lbd() || (a.lbd() == b.lbd() && a.activity() < b.activity()); } };
+void Solver::reduceDB(bool by_lbd)
 {
     int     i, j;
     double  extra_lim = cla_inc / learnts.size();    // Remove any clause below this activity
 
-    sort(learnts, reduceDB_lt());
+    if (by_lbd){
+        sort(learnts, reduceDB_lbd_lt(ca));
+        for (i = j = 0; i < learnts.size(); i++){
+            if (i < learnts.size() / 2 && ca[learnts[i]].size() > 2 && ca[learnts[i]].lbd() > 2 && !locked(learnts[i]))
+                remove(learnts[i]);
+            else
+                learnts[j++] = learnts[i];
+        }
+        learnts.shrink(i - j);
+        checkGarbage();
+        return;
+    }
+
+    sort(learnts, reduceDB_lt(ca));
     for (i = j = 0; i < learnts.size() / 2; i++){
-        if (learnts[i]->size() > 2 && !locked(learnts[i]))
+        if (ca[learnts[i]].size() > 2 && !locked(learnts[i]))
             remove(learnts[i]);
         else
             learnts[j++] = learnts[i];
     }
     for (; i < learnts.size(); i++){
-        if (learnts[i]->size() > 2 && !locked(learnts[i]) && learnts[i]->activity() < extra_lim)
+        if (ca[learnts[i]].size() > 2 && !locked(learnts[i]) && ca[learnts[i]].activity() < extra_lim)
             remove(learnts[i]);
         else
             learnts[j++] = learnts[i];
     }
     learnts.shrink(i - j);
+    checkGarbage();
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  garbageCollect : [void]  ->  [void]
+|  
+|  Description:
+|    Copy the live clauses into a fresh arena, dropping the space of removed ones, and update every
+|    reference to them (watchers, reasons and the clause lists).
+|________________________________________________________________________________________________@*/
+void Solver::garbageCollect()
+{
+    ClauseAllocator to;
+
+    for (int type = 0; type < 2; type++){
+        vec<vec<Watcher> >& wss = type ? watchesBin : watches;
+        for (int i = 0; i < wss.size(); i++){
+            vec<Watcher>& ws = wss[i];
+            for (int j = 0; j < ws.size(); j++)
+                ca.reloc(ws[j].cref, to);
+        }
+    }
+    for (int i = 0; i < trail.size(); i++){
+        Var x = var(trail[i]);
+        if (reason[x] != CRef_Undef){
+            assert(!ca[reason[x]].deleted());
+            ca.reloc(reason[x], to); }
+    }
+    for (int i = 0; i < clauses.size(); i++) ca.reloc(clauses[i], to);
+    for (int i = 0; i < learnts.size(); i++) ca.reloc(learnts[i], to);
+
+    to.moveTo(ca);
 }
 
 
@@ -599,7 +775,7 @@ void Solver::simplifyDB()
     if (!ok) return;    // GUARD (public method)
     assert(decisionLevel() == 0);
 
-    if (propagate() != NULL){
+    if (propagate() != CRef_Undef){
         ok = false;
         return; }
 
@@ -609,16 +785,18 @@ void Solver::simplifyDB()
     // Clear watcher lists:
     for (int i = simpDB_assigns; i < nAssigns(); i++){
         Lit p = trail[i];
-        watches[index( p)].clear(true);
-        watches[index(~p)].clear(true);
+        watches   [index( p)].clear(true);
+        watches   [index(~p)].clear(true);
+        watchesBin[index( p)].clear(true);
+        watchesBin[index(~p)].clear(true);
     }
 
     // Remove satisfied clauses:
     for (int type = 0; type < 2; type++){
-        vec<Clause*>& cs = type ? learnts : clauses;
+        vec<CRef>&    cs = type ? learnts : clauses;
         int           j  = 0;
         for (int i = 0; i < cs.size(); i++){
-            if (!locked(cs[i]) && simplify(cs[i]))
+            if (!locked(cs[i]) && simplify(ca[cs[i]]))
                 remove(cs[i]);
             else
                 cs[j++] = cs[i];
@@ -626,8 +804,56 @@ void Solver::simplifyDB()
         cs.shrink(cs.size()-j);
     }
 
+    if (released_vars.size() > 0)
+        freeReleased();
+
     simpDB_assigns = nAssigns();
     simpDB_props   = stats.clauses_literals + stats.learnts_literals;   // (shouldn't depend on 'stats' really, but it will do for now)
+    checkGarbage();
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  freeReleased : [void]  ->  [void]
+|  
+|  Description:
+|    Called by 'simplifyDB()' once the satisfied clauses are gone. Takes the variables fixed by
+|    'releaseVar()' off the top-level trail and puts them in 'free_vars'. A variable that was
+|    implied rather than fixed by its unit keeps its (locked) reason clause and is never reused.
+|________________________________________________________________________________________________@*/
+void Solver::freeReleased()
+{
+    assert(decisionLevel() == 0 && qhead == trail.size());
+    int n = 0;
+    for (int i = 0; i < released_vars.size(); i++){
+        Var v = released_vars[i];
+        if (reason[v] != CRef_Undef) continue;
+        assert(value(v) != l_Undef);
+        analyze_seen[v] = 1, n++; }
+    released_vars.clear();
+    if (n == 0) return;
+
+    int i, j, jh = 0;
+    for (i = j = 0; i < trail.size(); i++){
+        Var x = var(trail[i]);
+        if (analyze_seen[x]){
+            assert(watches[index(trail[i])].size() == 0 && watches[index(~trail[i])].size() == 0);
+            assert(watchesBin[index(trail[i])].size() == 0 && watchesBin[index(~trail[i])].size() == 0);
+            analyze_seen[x] = 0;
+            assigns  [x] = toInt(l_Undef);
+            level    [x] = -1;
+            trail_pos[x] = -1;
+            decision [x] = 0;
+            free_vars.push(x);
+        }else{
+            trail_pos[x] = j;
+            trail[j++]   = trail[i]; }
+        if (i < jhead) jh = j;
+    }
+    trail.shrink(i - j);
+    qhead = trail.size();
+    jhead = jh;
 }
 
 
@@ -652,13 +878,14 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
 
     stats.starts++;
     int     conflictC = 0;
+    lbd_queue.clear();
     var_decay = 1 / params.var_decay;
     cla_decay = 1 / params.clause_decay;
     model.clear();
 
     for (;;){
-        Clause* confl = propagate();
-        if (confl != NULL){
+        CRef confl = propagate();
+        if (confl != CRef_Undef){
             // CONFLICT
 
             stats.conflicts++; conflictC++;
@@ -669,17 +896,22 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 analyzeFinal(confl);
                 return l_False; }
             analyze(confl, learnt_clause, backtrack_level);
+            int lbd = computeLBD(learnt_clause);
+            lbd_queue.push(lbd);
+            lbd_sum += lbd; lbd_n++;
             cancelUntil(max(backtrack_level, root_level));
             newClause(learnt_clause, true, (proof != NULL) ? proof->last() : ClauseId_NULL);
             if (learnt_clause.size() == 1) level[var(learnt_clause[0])] = 0;    // (this is ugly (but needed for 'analyzeFinal()') -- in future versions, we will backtrack past the 'root_level' and redo the assumptions)
+            else ca[learnts.last()].lbd() = lbd;
             varDecayActivity();
             claDecayActivity();
 
         }else{
             // NO CONFLICT
 
-            if (nof_conflicts >= 0 && conflictC >= nof_conflicts){
-                // Reached bound on number of conflicts:
+            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()
+                || (params.restarts == restart_lbd && lbd_queue.full() && lbd_queue.avg() * lbd_restart_k > lbd_sum / lbd_n)){
+                // Reached bound on number of conflicts (or the budget), or the recent learnt clauses are worse than usual:
                 progress_estimate = progressEstimate();
                 cancelUntil(root_level);
                 return l_Undef; }
@@ -690,13 +922,13 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
 
             if (nof_learnts >= 0 && learnts.size()-nAssigns() >= nof_learnts)
                 // Reduce the set of learnt clauses:
-                reduceDB();
+                reduceDB(params.lbd_reduce);
 
             // New variable decision:
             stats.decisions++;
-            Var next = order.select(params.random_var_freq);
+            Lit next = pickBranchLit(params);
 
-            if (next == var_Undef){
+            if (next == lit_Undef){
                 // Model found:
                 model.growTo(nVars());
                 for (int i = 0; i < nVars(); i++) model[i] = value(i);
@@ -704,12 +936,50 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 return l_True;
             }
 
-            check(assume(~Lit(next)));
+            check(assume(next));
         }
     }
 }
 
 
+// Picks the next decision: a fanin to justify a gate if 'params.justify' is set and there is such a
+// gate, or else the most active unassigned decision variable (or a random one), negative unless
+// phase saving is on and it was last assigned TRUE. Returns 'lit_Undef' if all decision variables
+// are assigned.
+//
+Lit Solver::pickBranchLit(const SearchParams& params)
+{
+    if (params.justify){
+        Lit p = pickJustify();
+        if (p != lit_Undef)
+            return p; }
+
+    Var next = order.select(params.random_var_freq);
+    if (next == var_Undef)
+        return lit_Undef;
+    return Lit(next, params.phase_saving ? (bool)polarity[next] : true);
+}
+
+
+// Finds the first gate to justify on the trail (from 'jhead') that is FALSE while none of its fanins
+// is, and returns the more active fanin set to FALSE, or 'lit_Undef' if there is no such gate. Gates
+// that are TRUE need no decision, as propagation sets their fanins.
+//
+Lit Solver::pickJustify()
+{
+    for (; jhead < trail.size(); jhead++){
+        Lit p = trail[jhead];
+        Var x = var(p);
+        Lit a = gate_in[2*x], b = gate_in[2*x+1];
+        if (!jgate[x] || !sign(p) || value(a) == l_False || value(b) == l_False)
+            continue;
+        assert(value(a) == l_Undef && value(b) == l_Undef);     // (else propagation would have set the other one FALSE)
+        return activity[var(a)] >= activity[var(b)] ? ~a : ~b;
+    }
+    return lit_Undef;
+}
+
+
 // Return search-space coverage. Not extremely reliable.
 //
 double Solver::progressEstimate()
@@ -738,33 +1008,52 @@ void Solver::varRescaleActivity()
 void Solver::claRescaleActivity()
 {
     for (int i = 0; i < learnts.size(); i++)
-        learnts[i]->activity() *= 1e-20;
+        ca[learnts[i]].activity() *= 1e-20;
     cla_inc *= 1e-20;
 }
 
 
+// Element 'x' (from 0) of the Luby sequence with base 'y': 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ... for 'y' = 2.
+//
+static double luby(double y, int x)
+{
+    // Find the finite subsequence that contains index 'x', and its size:
+    int size, seq;
+    for (size = 1, seq = 0; size < x+1; seq++, size = 2*size+1);
+
+    while (size-1 != x){
+        size = (size-1)>>1;
+        seq--;
+        x = x % size;
+    }
+    return pow(y, seq);
+}
+
+
 /*_________________________________________________________________________________________________
 |
-|  solve : (assumps : const vec<Lit>&)  ->  [bool]
+|  solveLimited : (assumps : const vec<Lit>&)  ->  [lbool]
 |  
 |  Description:
 |    Top-level solve. If using assumptions (non-empty 'assumps' vector), you must call
 |    'simplifyDB()' first to see that no top-level conflict is present (which would put the solver
-|    in an undefined state).
+|    in an undefined state). Returns 'l_Undef' if the conflict or propagation budget (see
+|    'setConfBudget()' / 'setPropBudget()') runs out first.
 |  
 |  Input:
 |    A list of assumptions (unit clauses coded as literals). Pre-condition: The assumptions must
 |    not contain both 'x' and '~x' for any variable 'x'.
 |________________________________________________________________________________________________@*/
-bool Solver::solve(const vec<Lit>& assumps)
+lbool Solver::solveLimited(const vec<Lit>& assumps)
 {
     simplifyDB();
-    if (!ok) return false;
+    if (!ok) return l_False;
 
     SearchParams    params(default_params);
     double  nof_conflicts = 100;
-    double  nof_learnts   = nClauses() / 3;
+    double  nof_learnts   = nClauses() / 2;   // (a third, as in MiniSat, reduces the learnts too often on the incremental fraig miters)
     lbool   status        = l_Undef;
+    int     restarts      = 0;
 
     // Perform assumptions:
     root_level = assumps.size();
@@ -772,7 +1061,7 @@ bool Solver::solve(const vec<Lit>& assumps)
         Lit p = assumps[i];
         assert(var(p) < nVars());
         if (!assume(p)){
-            if (reason[var(p)] != NULL){
+            if (reason[var(p)] != CRef_Undef){
                 analyzeFinal(reason[var(p)], true);
                 conflict.push(~p);
             }else{
@@ -782,12 +1071,12 @@ bool Solver::solve(const vec<Lit>& assumps)
                 if (proof != NULL) conflict_id = unit_id[var(p)];
             }
             cancelUntil(0);
-            return false; }
-        Clause* confl = propagate();
-        if (confl != NULL){
+            return l_False; }
+        CRef confl = propagate();
+        if (confl != CRef_Undef){
             analyzeFinal(confl), assert(conflict.size() > 0);
             cancelUntil(0);
-            return false; }
+            return l_False; }
     }
     assert(root_level == decisionLevel());
 
@@ -815,14 +1104,18 @@ bool Solver::solve(const vec<Lit>& assumps)
                    progress_estimate*100);
             fflush(stdout);
         }
-        status = search((int)nof_conflicts, (int)nof_learnts, params);
+        if (params.restarts == restart_luby)
+            nof_conflicts = luby(2, restarts) * 100;
+        status = search(params.restarts == restart_lbd ? -1 : (int)nof_conflicts, (int)nof_learnts, params);
         nof_conflicts *= 1.5;
+        restarts++;
         nof_learnts   *= 1.1;
 
 if ((int)stats.conflicts >= effLimit) {
    cancelUntil(0);
-   return status == l_True;
+   return status;
 }
+        if (status == l_Undef && !withinBudget()) break;
     }
     if (verbosity >= 1) {
         reportf("===========================================");
@@ -830,7 +1123,7 @@ if ((int)stats.conflicts >= effLimit) {
     }
 
     cancelUntil(0);
-    return status == l_True;
+    return status;
 }
 
 void Solver::printStats()
@@ -40,9 +40,37 @@ struct SolverStats {
 };
 
 
+enum RestartType {
+    restart_geometric,  // After 100 conflicts, growing by 1.5 each restart.
+    restart_luby,       // After 100 conflicts times the Luby sequence (1 1 2 1 1 2 4 1 ...).
+    restart_lbd         // When the LBD of the recent learnt clauses gets worse than the overall average (as in Glucose).
+};
+
 struct SearchParams {
-    double  var_decay, clause_decay, random_var_freq;    // (reasonable values are: 0.95, 0.999, 0.02)    
-    SearchParams(double v = 1, double c = 1, double r = 0) : var_decay(v), clause_decay(c), random_var_freq(r) { }
+    double      var_decay, clause_decay, random_var_freq;    // (reasonable values are: 0.95, 0.999, 0.02)    
+    RestartType restarts;
+    bool        phase_saving;   // Branch on the last value of a variable instead of always on FALSE.
+    bool        lbd_reduce;     // 'reduceDB()' removes the learnt clauses of highest LBD first (else the least active ones).
+    bool        justify;        // Justify the gates (see 'setJustifyGate()') that are FALSE before any other decision.
+    SearchParams(double v = 1, double c = 1, double r = 0, RestartType rs = restart_geometric, bool ps = false, bool lr = false, bool j = false)
+        : var_decay(v), clause_decay(c), random_var_freq(r), restarts(rs), phase_saving(ps), lbd_reduce(lr), justify(j) { }
+};
+
+
+// The last 'max' values pushed and their sum:
+class BoundedQueue {
+    vec<int>    elems;
+    int         first, max;
+    int64       sum;
+public:
+    BoundedQueue(int m) : first(0), max(m), sum(0) { }
+    void    push (int x) {
+        if (elems.size() == max){ sum -= elems[first]; elems[first] = x; first = (first + 1) % max; }
+        else elems.push(x);
+        sum += x; }
+    bool    full () const { return elems.size() == max; }
+    double  avg  () const { return (double)sum / elems.size(); }
+    void    clear() { elems.clear(); first = 0; sum = 0; }
 };
 
 
@@ -51,8 +79,9 @@ protected:
     // Solver state:
     //
     bool                ok;               // If FALSE, the constraints are already unsatisfiable. No part of the solver state may be used!
-    vec<Clause*>        clauses;          // List of problem clauses.
-    vec<Clause*>        learnts;          // List of learnt clauses.
+    ClauseAllocator     ca;               // Holds all clauses; they are referred to by 'CRef' offsets into it.
+    vec<CRef>           clauses;          // List of problem clauses.
+    vec<CRef>           learnts;          // List of learnt clauses.
     vec<ClauseId>       unit_id;          // 'unit_id[var]' is the clause ID for the unit literal 'var' or '~var' (if set at toplevel).
     double              cla_inc;          // Amount to bump next clause with.
     double              cla_decay;        // INVERSE decay factor for clause activity: stores 1/decay.
@@ -60,27 +89,41 @@ protected:
     vec<double>         activity;         // A heuristic measurement of the activity of a variable.
     double              var_inc;          // Amount to bump next variable with.
     double              var_decay;        // INVERSE decay factor for variable activity: stores 1/decay. Use negative value for static variable order.
+    vec<char>           decision;         // 'decision[var]' is TRUE if the variable may be picked as a decision.
+    vec<char>           polarity;         // 'polarity[var]' is the sign of the last value of 'var' (TRUE = negative), for phase saving.
     VarOrder            order;            // Keeps track of the decision variable order.
 
-    vec<vec<Clause*> >  watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    vec<vec<Watcher> >  watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    vec<vec<Watcher> >  watchesBin;       // As 'watches[]', but for binary clauses; the blocker of a watcher is the other literal of its clause.
     vec<char>           assigns;          // The current assignments (lbool:s stored as char:s).
     vec<Lit>            trail;            // Assignment stack; stores all assigments made in the order they were made.
     vec<int>            trail_lim;        // Separator indices for different decision levels in 'trail[]'.
-    vec<Clause*>        reason;           // 'reason[var]' is the clause that implied the variables current value, or 'NULL' if none.
+    vec<Lit>            gate_in;          // 'gate_in[2*var]' and 'gate_in[2*var+1]' are the fanins of 'var' if it is a gate (see 'setGate()'), else 'lit_Undef'.
+    vec<char>           jgate;            // 'jgate[var]' is TRUE if the gate 'var' is to be justified when FALSE.
+    int                 jhead;            // Every gate that is FALSE in 'trail[0..jhead-1]' has a FALSE fanin.
+    vec<int>            jhead_lim;        // 'jhead' when each decision level was entered.
+    vec<CRef>           reason;           // 'reason[var]' is the clause that implied the variables current value, or 'CRef_Undef' if none.
     vec<int>            level;            // 'level[var]' is the decision level at which assignment was made.
     vec<int>            trail_pos;        // 'trail_pos[var]' is the variable's position in 'trail[]'. This supersedes 'level[]' in some sense, and 'level[]' will probably be removed in future releases.
+    vec<Var>            released_vars;    // Variables fixed by 'releaseVar()', freed by the next 'simplifyDB()' that removes the clauses.
+    vec<Var>            free_vars;        // Freed variables, handed out again by 'newVar()'.
     int                 root_level;       // Level of first proper decision.
     int                 qhead;            // Head of queue (as index into the trail -- no more explicit propagation queue in MiniSat).
     int                 simpDB_assigns;   // Number of top-level assignments since last execution of 'simplifyDB()'.
     int64               simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplifyDB()'.
+    int64               conflict_budget;    // Stop 'solveLimited()' at this many conflicts (-1 = no limit).
+    int64               propagation_budget; // Stop 'solveLimited()' at this many propagations (-1 = no limit).
+    BoundedQueue        lbd_queue;        // LBD of the latest learnt clauses (for 'restart_lbd').
+    double              lbd_sum;          // Sum of the LBD of all learnt clauses ...
+    int64               lbd_n;            // ... and their number.
 
     // Temporaries (to reduce allocation overhead). Each variable is prefixed by the method in which is used:
     //
     vec<char>           analyze_seen;
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
-    Clause*             propagate_tmpbin;
-    Clause*             analyze_tmpbin;
+    vec<int>            lbd_seen;
+    int                 lbd_stamp;
     vec<Lit>            addUnit_tmp;
     vec<Lit>            addBinary_tmp;
     vec<Lit>            addTernary_tmp;
@@ -91,13 +134,17 @@ protected:
     void        cancelUntil      (int level);
     void        record           (const vec<Lit>& clause);
 
-    void        analyze          (Clause* confl, vec<Lit>& out_learnt, int& out_btlevel); // (bt = backtrack)
+    void        analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
     bool        analyze_removable(Lit p, uint min_level);                                 // (helper method for 'analyze()')
-    void        analyzeFinal     (Clause* confl, bool skip_first = false);
-    bool        enqueue          (Lit fact, Clause* from = NULL);
-    Clause*     propagate        ();
-    void        reduceDB         ();
+    void        analyzeFinal     (CRef confl, bool skip_first = false);
+    bool        enqueue          (Lit fact, CRef from = CRef_Undef);
+    CRef        propagate        ();
+    void        logUnit          (CRef cr, Lit first);                                    // (helper method for 'propagate()')
+    int         computeLBD       (const vec<Lit>& ps);
+    void        reduceDB         (bool by_lbd = false);
+    void        garbageCollect   ();
     Lit         pickBranchLit    (const SearchParams& params);
+    Lit         pickJustify      ();                                                      // (helper method for 'pickBranchLit()')
     lbool       search           (int nof_conflicts, int nof_learnts, const SearchParams& params);
     double      progressEstimate ();
 
@@ -115,10 +162,22 @@ protected:
     // Operations on clauses:
     //
     void     newClause(const vec<Lit>& ps, bool learnt = false, ClauseId id = ClauseId_NULL, bool A = true);
-    void     claBumpActivity (Clause* c) { if ( (c->activity() += cla_inc) > 1e20 ) claRescaleActivity(); }
-    void     remove          (Clause* c, bool just_dealloc = false);
-    bool     locked          (const Clause* c) const { return reason[var((*c)[0])] == c; }
-    bool     simplify        (Clause* c) const;
+    void     claBumpActivity (Clause& c) { if ( (c.activity() += cla_inc) > 1e20 ) claRescaleActivity(); }
+    void     attach          (CRef cr);
+    void     remove          (CRef cr);
+    bool     locked          (CRef cr) const {
+        const Clause& c = ca[cr];
+        return reason[var(c[0])] == cr || (c.size() == 2 && reason[var(c[1])] == cr); }
+    bool     simplify        (const Clause& c) const;
+    void     freeReleased    ();
+    void     checkGarbage    () { if (ca.wasted() > ca.size() / 5) garbageCollect(); }    // (collect once 20% of the arena is wasted)
+
+    // 'propagate()' never reorders a binary clause, so as a reason its implied (true) literal may
+    // be the second one. Swap it into 'c[0]' where the analysis methods expect it:
+    Clause&  reasonClause(CRef cr) {
+        Clause& c = ca[cr];
+        if (c.size() == 2 && value(c[0]) == l_False){ Lit t = c[0]; c[0] = c[1]; c[1] = t; }
+        return c; }
 
     int      decisionLevel() const { return trail_lim.size(); }
 
@@ -128,31 +187,31 @@ public:
              , cla_decay        (1)
              , var_inc          (1)
              , var_decay        (1)
-             , order            (assigns, activity)
+             , order            (assigns, decision, activity)
+             , jhead            (0)
              , qhead            (0)
              , simpDB_assigns   (0)
              , simpDB_props     (0)
-             , default_params   (SearchParams(0.95, 0.999, 0.02))
+             , conflict_budget  (-1)
+             , propagation_budget(-1)
+             , lbd_queue        (50)
+             , lbd_sum          (0)
+             , lbd_n            (0)
+             , lbd_stamp        (0)
+             , default_params   (SearchParams(0.95, 0.999, 0.02, restart_luby, false, true))
              , expensive_ccmin  (2)
              , proof            (NULL)
              , verbosity        (0)
              , progress_estimate(0)
              , conflict_id      (ClauseId_NULL)
              {
-                vec<Lit> dummy(2,lit_Undef);
-                propagate_tmpbin = Clause_new(false, dummy);
-                analyze_tmpbin   = Clause_new(false, dummy);
+                lbd_seen      .growTo(1);       // (one per decision level, 0 to 'nVars()')
                 addUnit_tmp   .growTo(1);
                 addBinary_tmp .growTo(2);
                 addTernary_tmp.growTo(3);
              }
 
-   ~Solver() {
-       for (int i = 0; i < learnts.size(); i++) remove(learnts[i], true);
-       for (int i = 0; i < clauses.size(); i++) if (clauses[i] != NULL) remove(clauses[i], true);
-       remove(propagate_tmpbin, true);
-       remove(analyze_tmpbin, true);
-    }
+   ~Solver() { }     // (the clauses go with 'ca')
 
     // Helpers: (semi-internal)
     //
@@ -178,7 +237,12 @@ public:
 
     // Problem specification:
     //
-    Var     newVar    ();
+    Var     newVar    (bool dvar = true);
+    void    setDecisionVar(Var v, bool b);     // A variable that is not a decision one is only assigned by propagation.
+    void    setGate   (Var v, Lit a, Lit b);    // 'v' is the AND of 'a' and 'b' (the clauses must be added as well).
+    void    releaseVar(Lit p);                  // Make 'p' TRUE at the top level and never refer to 'var(p)' again; a later 'newVar()' may return it.
+    void    setJustifyGate(Var v, bool b) { assert(!b || gate_in[2*v] != lit_Undef); jgate[v] = (char)b; }
+    void    seedActivity(Var v, double a)   { if (a > activity[v]){ activity[v] = a; order.update(v); } }  // Raise the activity of a fresh variable, to rank it among the others that have not been bumped yet.
     int     nVars     ()                    { return assigns.size(); }
     void    addUnit   (Lit p)               { addUnit_tmp   [0] = p; addClause(addUnit_tmp); }
     void    addBinary (Lit p, Lit q)        { addBinary_tmp [0] = p; addBinary_tmp [1] = q; addClause(addBinary_tmp); }
@@ -190,8 +254,18 @@ public:
     //
     bool    okay() { return ok; }       // FALSE means solver is in an conflicting state (must never be used again!)
     void    simplifyDB();
-    bool    solve(const vec<Lit>& assumps);
+    bool    solve(const vec<Lit>& assumps) { return solveLimited(assumps) == l_True; }
     bool    solve() { vec<Lit> tmp; return solve(tmp); }
+    lbool   solveLimited(const vec<Lit>& assumps);  // l_Undef if a budget ran out
+
+    // Resource budgets, counted from now; negative means no limit:
+    //
+    void    setConfBudget(int64 x) { conflict_budget    = x < 0 ? -1 : stats.conflicts    + x; }
+    void    setPropBudget(int64 x) { propagation_budget = x < 0 ? -1 : stats.propagations + x; }
+    void    budgetOff()            { conflict_budget = propagation_budget = -1; }
+    bool    withinBudget() const {
+        return (conflict_budget    < 0 || stats.conflicts    < conflict_budget)
+            && (propagation_budget < 0 || stats.propagations < propagation_budget); }
 
     double      progress_estimate;  // Set by 'search()'.
     vec<lbool>  model;              // If problem is satisfiable, this vector contains the model (if any).
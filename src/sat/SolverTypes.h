@@ -79,62 +79,111 @@ inline int toDimacs(Lit p) { return sign(p) ? -var(p) - 1 : var(p) + 1; }
 typedef int ClauseId;     // (might have to use uint64 one day...)
 const   int ClauseId_NULL = INT_MIN;
 
+// Clauses live in a 'ClauseAllocator' and are referred to by their 32-bit offset into it:
+typedef uint CRef;
+const   CRef CRef_Undef = UINT_MAX;
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 class Clause {
-    uint    size_learnt;
+    uint    size_     : 28;
+    uint    learnt_   : 1;
+    uint    has_id    : 1;
+    uint    deleted_  : 1;
+    uint    reloced_  : 1;      // (moved by 'ClauseAllocator::reloc()'; 'data[0]' is the new reference)
     Lit     data[1];
 public:
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
     Clause(bool learnt, const vec<Lit>& ps, ClauseId id_ = ClauseId_NULL) {
-        size_learnt = (ps.size() << 1) | (int)learnt;
+        size_ = ps.size(); learnt_ = learnt; has_id = id_ != ClauseId_NULL; deleted_ = reloced_ = 0;
         for (int i = 0; i < ps.size(); i++) data[i] = ps[i];
-        if (learnt) activity() = 0;
-        if (id_ != ClauseId_NULL) id() = id_; }
+        if (learnt) activity() = 0, lbd() = 0;
+        if (has_id) id() = id_; }
 
-    // -- use this function instead:
-    friend Clause* Clause_new(bool, const vec<Lit>&, ClauseId);
+    // -- use 'ClauseAllocator::alloc()' instead.
 
-    int       size        ()      const { return size_learnt >> 1; }
-    bool      learnt      ()      const { return size_learnt & 1; }
+    int       size        ()      const { return size_; }
+    bool      learnt      ()      const { return learnt_; }
+    bool      deleted     ()      const { return deleted_; }
     Lit       operator [] (int i) const { return data[i]; }
     Lit&      operator [] (int i)       { return data[i]; }
     float&    activity    ()      const {
         void *p = const_cast<Lit*>(&data[size()]); return *((float *)p);
     } //              return *((float*)&data[size()]); }
-    ClauseId& id          ()      const { return *((ClauseId*)&data[size() + (int)learnt()]); }
-};
+    uint&     lbd         ()      const { return *((uint*)&data[size() + 1]); }        // (learnt clauses only: #decision levels when learnt)
+    ClauseId& id          ()      const { return *((ClauseId*)&data[size() + 2*(int)learnt()]); }
 
-inline Clause* Clause_new(bool learnt, const vec<Lit>& ps, ClauseId id = ClauseId_NULL) {
-    assert(sizeof(Lit)      == sizeof(uint));
-    assert(sizeof(float)    == sizeof(uint));
-    assert(sizeof(ClauseId) == sizeof(uint));
-    void*   mem = xmalloc<char>(sizeof(Clause) + sizeof(uint)*(ps.size() + (int)learnt + (int)(id != ClauseId_NULL)));
-    return new (mem) Clause(learnt, ps, id); }
+    // Size in 32-bit words, header included:
+    static int words(int size, bool learnt, bool has_id) { return 1 + size + 2*(int)learnt + (int)has_id; }
+    int        words() const { return words(size(), learnt(), has_id); }
+
+    friend class ClauseAllocator;
+};
 
 
 //=================================================================================================
-// GClause -- Generalize clause:
+// ClauseAllocator -- an arena of clauses:
 
 
-// Either a pointer to a clause or a literal.
-class GClause {
-    void*   data;
-    GClause(void* d) : data(d) {}
+// All clauses of a solver are stored back to back in one array and referred to by 'CRef'
+// offsets, so they stay close in memory and a reference takes half the space of a pointer.
+// A freed clause is only marked and its space counted in 'wasted()'; the solver copies the live
+// clauses into a fresh arena ('reloc()') once enough space is wasted.
+// NOTE! 'alloc()' may move the arena: do not keep a 'Clause&' across it.
+class ClauseAllocator {
+    vec<uint>   mem;
+    int         wasted_;
 public:
-    friend GClause GClause_new(Lit p);
-    friend GClause GClause_new(Clause* c);
-
-    bool        isLit    () const { return ((uintp)data & 1) == 1; }
-    Lit         lit      () const { return toLit(((intp)data) >> 1); }
-    Clause*     clause   () const { return (Clause*)data; }
-    bool        operator == (GClause c) const { return data == c.data; }
-    bool        operator != (GClause c) const { return data != c.data; }
+    ClauseAllocator() : wasted_(0) { }
+
+    CRef alloc(const vec<Lit>& ps, bool learnt, ClauseId id = ClauseId_NULL) {
+        assert(sizeof(Lit)      == sizeof(uint));
+        assert(sizeof(float)    == sizeof(uint));
+        assert(sizeof(ClauseId) == sizeof(uint));
+        CRef    cr = mem.size();
+        mem.growTo(cr + Clause::words(ps.size(), learnt, id != ClauseId_NULL));
+        new (&mem[cr]) Clause(learnt, ps, id);
+        return cr; }
+    void free(CRef cr) {
+        Clause& c = (*this)[cr];
+        assert(!c.deleted_);
+        c.deleted_ = 1;
+        wasted_   += c.words(); }
+
+    Clause&       operator [] (CRef cr)       { return (Clause&)mem[cr]; }
+    const Clause& operator [] (CRef cr) const { return (const Clause&)mem[cr]; }
+
+    int  size  () const { return mem.size(); }
+    int  wasted() const { return wasted_; }
+
+    // Copy the clause of 'cr' (once) into 'to' and update 'cr':
+    void reloc(CRef& cr, ClauseAllocator& to) {
+        Clause& c = (*this)[cr];
+        if (c.reloced_){ cr = (CRef)index(c.data[0]); return; }
+        CRef    nr = to.mem.size();
+        int     n  = c.words();
+        to.mem.growTo(nr + n);
+        memcpy(&to.mem[nr], &mem[cr], n * sizeof(uint));
+        c.reloced_ = 1;
+        c.data[0]  = toLit((int)nr);
+        cr = nr; }
+    void moveTo(ClauseAllocator& to) { mem.moveTo(to.mem); to.wasted_ = wasted_; wasted_ = 0; }
 };
-inline GClause GClause_new(Lit p)     { return GClause((void*)(((intp)index(p) << 1) + 1)); }
-inline GClause GClause_new(Clause* c) { assert(((uintp)c & 1) == 0); return GClause((void*)c); }
 
-#define GClause_NULL GClause_new((Clause*)NULL)
+
+//=================================================================================================
+// Watcher -- an entry of a watch list:
+
+
+// 'blocker' is a literal of the clause other than the watched one. For a binary clause it is
+// the other literal, so the clause itself never needs to be read by 'propagate()'; for a longer
+// clause a true 'blocker' lets 'propagate()' skip the clause without reading it.
+struct Watcher {
+    CRef    cref;
+    Lit     blocker;
+    Watcher() : cref(CRef_Undef) { }
+    Watcher(CRef cr, Lit p) : cref(cr), blocker(p) { }
+};
 
 
 //=================================================================================================
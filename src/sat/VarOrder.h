@@ -35,14 +35,15 @@ struct VarOrder_lt {
 
 class VarOrder {
     const vec<char>&    assigns;     // var->val. Pointer to external assignment table.
+    const vec<char>&    decision;    // var->flag. Only decision variables are selected.
 //    const vec<double>&  activity;    // var->act. Pointer to external activity table.
     Heap<VarOrder_lt>   heap;
     double              random_seed; // For the internal random number generator
 
 public:
-    VarOrder(const vec<char>& ass, const vec<double>& act) :
+    VarOrder(const vec<char>& ass, const vec<char>& dec, const vec<double>& act) :
 //        assigns(ass), activity(act), heap(VarOrder_lt(act)), random_seed(91648253)
-        assigns(ass), heap(VarOrder_lt(act)), random_seed(91648253)
+        assigns(ass), decision(dec), heap(VarOrder_lt(act)), random_seed(91648253)
         { }
 
     inline void newVar(void);
@@ -55,7 +56,8 @@ public:
 void VarOrder::newVar(void)
 {
     heap.setBounds(assigns.size());
-    heap.insert(assigns.size()-1);
+    if (decision[assigns.size()-1])
+        heap.insert(assigns.size()-1);
 }
 
 
@@ -68,7 +70,7 @@ void VarOrder::update(Var x)
 
 void VarOrder::undo(Var x)
 {
-    if (!heap.inHeap(x))
+    if (decision[x] && !heap.inHeap(x))
         heap.insert(x);
 }
 
@@ -78,14 +80,14 @@ Var VarOrder::select(double random_var_freq)
     // Random decision:
     if (drand(random_seed) < random_var_freq && !heap.empty()){
         Var next = irand(random_seed,assigns.size());
-        if (toLbool(assigns[next]) == l_Undef)
+        if (toLbool(assigns[next]) == l_Undef && decision[next])
             return next;
     }
 
     // Activity based decision:
     while (!heap.empty()){
         Var next = heap.getmin();
-        if (toLbool(assigns[next]) == l_Undef)
+        if (toLbool(assigns[next]) == l_Undef && decision[next])
             return next;
     }
 
@@ -35,13 +35,27 @@ class SatSolver
 
       // Constructing proof model
       // Return the Var ID of the new Var
-      inline Var newVar() { _solver->newVar(); return _curVar++; }
+      inline Var newVar(bool dvar = true) { ++_curVar; return _solver->newVar(dvar); }
+      // Only decision variables are branched on; the others are assigned
+      // by propagation alone, so a SAT model leaves them undefined unless
+      // they are implied
+      void setDecisionVar(Var v, bool d) { _solver->setDecisionVar(v, d); }
+      // Circuit mode: before any other decision, the solver justifies the
+      // AND gates of addAigCNF() that are 0 by setting one of their fanins
+      // to 0; the decision variables are then only needed to pick the
+      // values the gates are justified from. Only the gates turned on by
+      // setJustifyGate() are justified.
+      void setJustify(bool j) { _solver->default_params.justify = j; }
+      void setJustifyGate(Var v, bool j) { _solver->setJustifyGate(v, j); }
+      // Rank v among the variables that have no activity yet
+      void seedActivity(Var v, double a) { _solver->seedActivity(v, a); }
       // fa/fb = true if it is inverted
       void addAigCNF(Var vf, Var va, bool fa, Var vb, bool fb) {
          vec<Lit> lits;
          Lit lf = Lit(vf);
          Lit la = fa? ~Lit(va): Lit(va);
          Lit lb = fb? ~Lit(vb): Lit(vb);
+         _solver->setGate(vf, la, lb);
          lits.push(la); lits.push(~lf);
          _solver->addClause(lits); lits.clear();
          lits.push(lb); lits.push(~lf);
@@ -64,6 +78,67 @@ class SatSolver
          lits.push(~la); lits.push(~lb); lits.push(~lf);
          _solver->addClause(lits); lits.clear();
       }
+      // vf = ins[0] & ins[1] & ...; one binary clause per input and a
+      // long one, instead of a chain of 2-input ANDs
+      void addAndCNF(Var vf, const vec<Lit>& ins) {
+         vec<Lit> lits;
+         Lit lf = Lit(vf);
+         for (int i = 0; i < ins.size(); ++i) {
+            lits.push(ins[i]); lits.push(~lf);
+            _solver->addClause(lits); lits.clear();
+         }
+         for (int i = 0; i < ins.size(); ++i) lits.push(~ins[i]);
+         lits.push(lf);
+         _solver->addClause(lits); lits.clear();
+      }
+      // vf = vs? vt: ve; fs/ft/fe = true if it is inverted. The last two
+      // clauses are redundant but let vf follow vt == ve without vs.
+      void addMuxCNF(Var vf, Var vs, bool fs, Var vt, bool ft,
+                     Var ve, bool fe) {
+         vec<Lit> lits;
+         Lit lf = Lit(vf);
+         Lit ls = fs? ~Lit(vs): Lit(vs);
+         Lit lt = ft? ~Lit(vt): Lit(vt);
+         Lit le = fe? ~Lit(ve): Lit(ve);
+         lits.push(~ls); lits.push(~lt); lits.push( lf);
+         _solver->addClause(lits); lits.clear();
+         lits.push(~ls); lits.push( lt); lits.push(~lf);
+         _solver->addClause(lits); lits.clear();
+         lits.push( ls); lits.push(~le); lits.push( lf);
+         _solver->addClause(lits); lits.clear();
+         lits.push( ls); lits.push( le); lits.push(~lf);
+         _solver->addClause(lits); lits.clear();
+         lits.push(~lt); lits.push(~le); lits.push( lf);
+         _solver->addClause(lits); lits.clear();
+         lits.push( lt); lits.push( le); lits.push(~lf);
+         _solver->addClause(lits); lits.clear();
+      }
+
+      // act -> (va != vb), or act -> (va == vb) if inv; only the half of
+      // the XOR that a proof needs. Assume "act" to test the miter and
+      // release it by !act afterwards (releaseVar()): the clauses are then
+      // satisfied at the top level, simplifyDB() drops them and "act" is
+      // free for the next miter.
+      void addMiterCNF(Var act, Var va, Var vb, bool inv) {
+         vec<Lit> lits;
+         Lit lt = Lit(act);
+         Lit la = Lit(va);
+         Lit lb = inv? ~Lit(vb): Lit(vb);
+         lits.push(~lt); lits.push( la); lits.push( lb);
+         _solver->addClause(lits); lits.clear();
+         lits.push(~lt); lits.push(~la); lits.push(~lb);
+         _solver->addClause(lits); lits.clear();
+      }
+      // va == vb (or va == !vb if inv)
+      void addEqCNF(Var va, Var vb, bool inv) {
+         vec<Lit> lits;
+         Lit la = Lit(va);
+         Lit lb = inv? ~Lit(vb): Lit(vb);
+         lits.push(~la); lits.push( lb);
+         _solver->addClause(lits); lits.clear();
+         lits.push( la); lits.push(~lb);
+         _solver->addClause(lits); lits.clear();
+      }
 
       // For incremental proof, use "assumeSolve()"
       void assumeRelease() { _assump.clear(); }
@@ -71,11 +146,27 @@ class SatSolver
          _assump.push(val? Lit(prop): ~Lit(prop));
       }
       bool assumpSolve() { return _solver->solve(_assump); }
+      // Resource-limited assumpSolve(): 1 (SAT), 0 (UNSAT) or -1 if the
+      // conflict/propagation budget of this call runs out; a negative
+      // budget means no limit
+      int assumpSolve(int64 conflicts, int64 props) {
+         _solver->setConfBudget(conflicts);
+         _solver->setPropBudget(props);
+         lbool r = _solver->solveLimited(_assump);
+         _solver->budgetOff();
+         return r == l_True? 1: r == l_False? 0: -1;
+      }
 
       // For one time proof, use "solve"
       void assertProperty(Var prop, bool val) {
          _solver->addUnit(val? Lit(prop): ~Lit(prop));
       }
+      // assertProperty(), and "prop" is never used again: every clause of
+      // it must be satisfied by "val" (e.g. an activation variable retired
+      // by val = false), and a later newVar() may return it
+      void releaseVar(Var prop, bool val) {
+         _solver->releaseVar(val? Lit(prop): ~Lit(prop));
+      }
       bool solve() { _solver->solve(); return _solver->okay(); }
 
       // Functions about Reporting